@@ -0,0 +1,95 @@
+/**
+ * @file glps_stats_page.h
+ * @brief Layout of the live statistics page GLPS publishes in shared memory.
+ *
+ * The page lives in a memfd named "glps-stats" and is rewritten a few times
+ * per second under a sequence lock. External tools such as glps-top map it
+ * read-only through /proc/<pid>/fd and never slow down the application.
+ */
+
+#ifndef GLPS_STATS_PAGE_H
+#define GLPS_STATS_PAGE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define GLPS_STATS_PAGE_NAME "glps-stats"  /**< Name of the memfd holding the page. */
+#define GLPS_STATS_PAGE_MAGIC 0x53504c47u  /**< "GLPS" in little endian. */
+#define GLPS_STATS_PAGE_VERSION 1          /**< Bumped whenever the layout changes. */
+#define GLPS_STATS_MAX_WINDOWS 16          /**< Windows published, in id order. */
+#define GLPS_STATS_HISTOGRAM_BUCKETS 11    /**< Frame-time histogram buckets. */
+
+/**
+ * @struct glps_StatsWindow
+ * @brief Frame statistics of one window.
+ */
+typedef struct
+{
+  uint32_t window_id;           /**< Window id in the application. */
+  uint32_t sample_count;        /**< Frames the figures are computed from. */
+  uint64_t frame_count;         /**< Frames since the window was created. */
+  uint64_t over_budget_frames;  /**< Frames over the window's frame budget. */
+  double fps;                   /**< Frame rate over the recent frames. */
+  double mean_ms;               /**< Mean frame time. */
+  double p95_ms;                /**< 95th percentile frame time. */
+  double p99_ms;                /**< 99th percentile frame time. */
+  double max_ms;                /**< Longest recent frame time. */
+  uint32_t histogram[GLPS_STATS_HISTOGRAM_BUCKETS]; /**< Recent frames per bucket of @ref glps_StatsPage::histogram_edges_us. */
+} glps_StatsWindow;
+
+/**
+ * @struct glps_StatsPage
+ * @brief Counters of a running GLPS application.
+ *
+ * Counters prefixed total_ grow for the lifetime of the process; diff two
+ * reads to get a rate.
+ */
+typedef struct glps_StatsPage
+{
+  uint32_t magic;                 /**< GLPS_STATS_PAGE_MAGIC. */
+  uint32_t version;               /**< GLPS_STATS_PAGE_VERSION. */
+  atomic_uint sequence;           /**< Odd while the page is being written. */
+  int32_t pid;                    /**< Publishing process. */
+  uint64_t publish_ns;            /**< Monotonic time of the last publish. */
+  uint64_t publish_count;         /**< Number of publishes so far. */
+  uint32_t tasks_pending;         /**< Tasks posted to the event thread and not run yet. */
+  uint32_t display_events_pending;/**< Display events read and not yet handled, 0 if unknown. */
+  uint64_t total_coalesced_events;/**< Input events merged into a later one. */
+  uint64_t total_audio_xruns;     /**< Audio buffer underruns. */
+  uint64_t total_log_dropped;     /**< Log messages filtered out by level or switch. */
+  uint32_t histogram_edges_us[GLPS_STATS_HISTOGRAM_BUCKETS - 1]; /**< Upper bounds of the histogram buckets but the last. */
+  uint32_t window_count;          /**< Valid entries in @ref windows. */
+  glps_StatsWindow windows[GLPS_STATS_MAX_WINDOWS];
+} glps_StatsPage;
+
+/**
+ * @brief Takes a consistent copy of a page that is being written.
+ * @param page Mapped page.
+ * @param copy Receives the copy.
+ * @return false if the writer kept the page busy for every attempt.
+ */
+static inline bool glps_stats_page_read(const glps_StatsPage *page,
+                                        glps_StatsPage *copy)
+{
+  for (int attempt = 0; attempt < 64; ++attempt)
+  {
+    unsigned int before =
+        atomic_load_explicit(&page->sequence, memory_order_acquire);
+    if (before & 1u)
+      continue;
+
+    memcpy(copy, (const void *)page, sizeof(*copy));
+
+    atomic_thread_fence(memory_order_acquire);
+    unsigned int after =
+        atomic_load_explicit(&page->sequence, memory_order_relaxed);
+    if (before == after)
+      return true;
+  }
+
+  return false;
+}
+
+#endif
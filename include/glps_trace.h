@@ -0,0 +1,92 @@
+/**
+ * @file glps_trace.h
+ * @brief Lightweight span tracing of GLPS internals, exportable as a Chrome
+ * JSON trace or a Perfetto protobuf trace.
+ *
+ * Spans are recorded into per-thread buffers with nanosecond timestamps. When
+ * tracing is disabled a span costs a single relaxed load.
+ */
+
+#ifndef GLPS_TRACE_H
+#define GLPS_TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define GLPS_TRACE_BUFFER_CAPACITY 8192 /**< Spans kept per thread. */
+
+extern atomic_bool glps_trace_enabled_flag;
+
+/**
+ * @brief Returns whether span recording is enabled.
+ */
+static inline bool glps_trace_is_enabled(void)
+{
+  return atomic_load_explicit(&glps_trace_enabled_flag, memory_order_relaxed);
+}
+
+/**
+ * @brief Enables or disables span recording for all threads.
+ * @param enabled If true, spans are recorded.
+ */
+void glps_trace_enable(bool enabled);
+
+/**
+ * @brief Starts a span on the calling thread.
+ * @return Start timestamp to hand to glps_trace_end().
+ */
+uint64_t glps_trace_begin(void);
+
+/**
+ * @brief Ends a span started with glps_trace_begin().
+ * @param name Span name. Must outlive the trace (use string literals).
+ * @param start_ns Timestamp returned by glps_trace_begin().
+ */
+void glps_trace_end(const char *name, uint64_t start_ns);
+
+/**
+ * @brief Names the calling thread in exported traces.
+ * @param name Thread name, copied.
+ */
+void glps_trace_set_thread_name(const char *name);
+
+/**
+ * @brief Discards all recorded spans.
+ *
+ * Safe to call while other threads record spans; spans ending after the call
+ * are kept.
+ */
+void glps_trace_clear(void);
+
+/**
+ * @brief Writes recorded spans as a Chrome trace-event JSON file.
+ * @param path Output file path.
+ * @return true on success.
+ */
+bool glps_trace_dump_chrome_json(const char *path);
+
+/**
+ * @brief Writes recorded spans as a Perfetto protobuf trace.
+ * @param path Output file path.
+ * @return true on success.
+ */
+bool glps_trace_dump_perfetto(const char *path);
+
+/**
+ * @brief Opens a span; evaluates to 0 when tracing is disabled.
+ */
+#define GLPS_TRACE_BEGIN() (glps_trace_is_enabled() ? glps_trace_begin() : 0)
+
+/**
+ * @brief Closes a span opened with GLPS_TRACE_BEGIN().
+ */
+#define GLPS_TRACE_END(name, start_ns)                                         \
+  do                                                                           \
+  {                                                                            \
+    if (start_ns)                                                              \
+      glps_trace_end(name, start_ns);                                          \
+  } while (0)
+
+#endif // GLPS_TRACE_H
@@ -73,6 +73,56 @@ void glps_wm_window_set_close_callback(
     glps_WindowManager *wm,
     void (*window_close_callback)(size_t window_id, void *data), void *data);
 
+/**
+ * @brief Allows user to set callback to handle window visibility changes.
+ *
+ * A window is hidden while it is unmapped, minimized, fully covered,
+ * suspended by the compositor or starved of frame callbacks. Frame callbacks
+ * of hidden windows are skipped; applications can use this callback to pause
+ * their simulations as well.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_visibility_callback user-set visibility callback.
+ * @param data Additional data to pass to the callback.
+ */
+void glps_wm_window_set_visibility_callback(
+    glps_WindowManager *wm,
+    void (*window_visibility_callback)(size_t window_id, bool visible,
+                                       void *data),
+    void *data);
+
+/**
+ * @brief Returns whether a window is currently visible.
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @return true if the window can be seen.
+ */
+bool glps_wm_window_is_visible(glps_WindowManager *wm, size_t window_id);
+
+/**
+ * @brief Chooses when frame callbacks of a window are dispatched.
+ *
+ * In GLPS_RENDER_ON_DEMAND mode the frame callback only runs after
+ * glps_wm_request_redraw(), input or a resize, so a static window costs no
+ * CPU or GPU time.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param mode Render mode.
+ */
+void glps_wm_window_set_render_mode(glps_WindowManager *wm, size_t window_id,
+                                    GLPS_RENDER_MODE mode);
+
+/**
+ * @brief Schedules one frame callback for a window.
+ *
+ * Requests made before the frame is drawn merge into a single frame.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ */
+void glps_wm_request_redraw(glps_WindowManager *wm, size_t window_id);
+
 /**
  * @brief Sets the OpenGL context of a specific window as the current context.
  * @param wm Pointer to the GLPS Window Manager.
@@ -103,6 +153,72 @@ void glps_wm_window_update(glps_WindowManager *wm, size_t window_id);
  */
 void glps_wm_window_destroy(glps_WindowManager *wm, size_t window_id);
 
+/**
+ * @brief Keeps hidden windows ready so creating a window only maps one.
+ *
+ * Pooled windows are created up front with their EGL surfaces.
+ * glps_wm_window_create() takes one from the pool, and
+ * glps_wm_window_destroy() puts windows back while the pool is below
+ * @p count. Only supported on Wayland.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param count Windows to keep pooled, at most GLPS_MAX_POOLED_WINDOWS.
+ *              0 frees the pool.
+ * @return Number of windows in the pool.
+ * @note Requires an existing window, whose context the pool shares.
+ */
+size_t glps_wm_window_pool_reserve(glps_WindowManager *wm, size_t count);
+
+/**
+ * @brief Creates a popup for a menu or tooltip, placed relative to a parent.
+ *
+ * On Wayland the popup is an xdg_popup that the compositor may flip or slide
+ * to keep on screen. On X11 it is an override-redirect window. A dismissed
+ * popup, e.g. after a click outside of a grabbing one, is reported through
+ * the close callback and should then be destroyed.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param parent_id Window the popup belongs to.
+ * @param x Horizontal offset of the popup from the parent's origin.
+ * @param y Vertical offset of the popup from the parent's origin.
+ * @param width Width of the popup in pixels.
+ * @param height Height of the popup in pixels.
+ * @param grab If true, the popup takes pointer and keyboard input as a menu
+ *             does. Tooltips should pass false.
+ * @return ID of the popup, or -1 on failure.
+ */
+ssize_t glps_wm_popup_create(glps_WindowManager *wm, size_t parent_id, int x,
+                             int y, int width, int height, bool grab);
+
+/**
+ * @brief Creates a layer composited inside a parent window.
+ *
+ * The layer is drawn independently of its parent. A static parent rendered
+ * with GLPS_RENDER_ON_DEMAND is then sent to the compositor once, and only
+ * the layer is redrawn each frame. On Wayland the layer is a desynchronized
+ * wl_subsurface. On X11 it is a child window.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param parent_id Window the layer is placed in.
+ * @param x Horizontal position inside the parent.
+ * @param y Vertical position inside the parent.
+ * @param width Width of the layer in pixels.
+ * @param height Height of the layer in pixels.
+ * @return ID of the layer, or -1 on failure.
+ */
+ssize_t glps_wm_subsurface_create(glps_WindowManager *wm, size_t parent_id,
+                                  int x, int y, int width, int height);
+
+/**
+ * @brief Moves a layer created with glps_wm_subsurface_create().
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the layer.
+ * @param x Horizontal position inside the parent.
+ * @param y Vertical position inside the parent.
+ */
+void glps_wm_subsurface_set_position(glps_WindowManager *wm, size_t window_id,
+                                     int x, int y);
+
 /**
  * @brief Cleans up and destroys the GLPS Window Manager.
  * @param wm Pointer to the GLPS Window Manager.
@@ -110,14 +226,111 @@ void glps_wm_window_destroy(glps_WindowManager *wm, size_t window_id);
 void glps_wm_destroy(glps_WindowManager *wm);
 
 /**
- * @brief Returns the total window count.
+ * @brief Returns the number of open windows.
+ *
+ * Window ids stay the same until their window is destroyed, and the id of a
+ * destroyed window may be given to a later one. Ids are therefore not
+ * contiguous and may exceed this count.
+ *
  * @param wm Pointer to the GLPS Window Manager.
- * @return total window count.
+ * @return Number of open windows.
  */
 size_t glps_wm_get_window_count(glps_WindowManager *wm);
 
 bool glps_wm_should_close(glps_WindowManager *wm);
 
+/**
+ * @brief Runs a function on the thread calling glps_wm_should_close().
+ *
+ * Safe to call from any thread. Posting never blocks, and it wakes the event
+ * thread even while it waits for display events. Tasks run in posting order,
+ * at most GLPS_EVENT_LOOP_BATCH per glps_wm_should_close() call.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param fn Function to run.
+ * @param arg Argument handed to @p fn.
+ * @return false if the task could not be queued.
+ */
+bool glps_wm_post(glps_WindowManager *wm, void (*fn)(void *arg), void *arg);
+
+/**
+ * @brief Runs the main loop until all windows are closed.
+ *
+ * Replaces a hand-written glps_wm_should_close() loop. The update callback
+ * runs at the fixed rate of @p desc, as often as needed to catch up with real
+ * time. The render callback runs at its own rate and gets how far real time
+ * is between the last two updates, to interpolate with. Between renders the
+ * idle callback is called chunk by chunk for as long as a chunk still ends
+ * before the next render is due, and the loop sleeps for the rest.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param desc Loop description, copied.
+ */
+void glps_wm_run(glps_WindowManager *wm, const glps_LoopDesc *desc);
+
+/**
+ * @brief Publishes live counters for external inspection.
+ *
+ * Four times a second, frame-time statistics per window, event queue depths
+ * and process counters are written to a shared-memory page laid out as in
+ * glps_stats_page.h. The glps-top tool reads it without touching the
+ * application. Setting GLPS_STATS_PAGE in the environment enables the page
+ * from glps_wm_init(). Linux only.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param enabled If true, the page is created, otherwise removed.
+ * @return false if the page could not be created.
+ */
+bool glps_wm_set_stats_page(glps_WindowManager *wm, bool enabled);
+
+/**
+ * @brief Watches a descriptor from the event loop.
+ *
+ * Sockets, timerfds or inotify descriptors are polled together with the
+ * display connection. Their callbacks run on the thread calling
+ * glps_wm_should_close(), so no extra thread or locking is needed. Adding a
+ * descriptor that is already watched replaces its watch. Not supported on
+ * Win32.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param fd Descriptor to watch. It stays owned by the caller.
+ * @param events GLPS_FD_EVENT flags to wait for.
+ * @param callback Called with the GLPS_FD_EVENT flags that are ready.
+ * @param data User data handed to @p callback.
+ * @return false if the descriptor could not be watched.
+ * @note Call from the event thread only.
+ */
+bool glps_wm_add_fd(glps_WindowManager *wm, int fd, unsigned int events,
+                    void (*callback)(int fd, unsigned int events, void *data),
+                    void *data);
+
+/**
+ * @brief Stops watching a descriptor added with glps_wm_add_fd().
+ *
+ * Safe to call from a watch callback, including the descriptor's own. Remove
+ * a descriptor before closing it.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param fd Descriptor to forget.
+ */
+void glps_wm_remove_fd(glps_WindowManager *wm, int fd);
+
+/**
+ * @brief Reads the display connection on a dedicated thread.
+ *
+ * The reader thread takes events off the socket as soon as they arrive and
+ * hands them to the thread calling glps_wm_should_close() without locks, so a
+ * long frame no longer delays reading and a burst of input is already decoded
+ * when the frame ends. Callbacks still run on the event thread. Not supported
+ * on Win32, where messages belong to the thread that created the window.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param enabled If true, the reader thread is started, otherwise stopped.
+ * @return false if the reader could not be started.
+ * @note Call from the event thread only.
+ */
+bool glps_wm_set_event_thread(glps_WindowManager *wm, bool enabled);
+
 /* ======= Events: I/O Devices ======= */
 
 /**
@@ -185,6 +398,27 @@ void glps_wm_set_mouse_move_callback(
                                 double mouse_y, void *data),
     void *data);
 
+/**
+ * @brief Latches pointer input right before each swap.
+ *
+ * While set, glps_wm_swap_buffers() first takes the pointer motion that
+ * arrived during the frame, merges it into one move, and then calls
+ * @p late_latch_callback with the freshest position if the pointer is over
+ * the window. Draw pointer-following content such as drag handles from the
+ * callback; the window's context is still current. This saves up to a frame
+ * of latency.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param late_latch_callback Function to call before a swap, NULL to stop
+ * latching.
+ * @param data User data handed to @p late_latch_callback.
+ */
+void glps_wm_set_late_latch_callback(
+    glps_WindowManager *wm,
+    void (*late_latch_callback)(size_t window_id, double mouse_x,
+                                double mouse_y, void *data),
+    void *data);
+
 /**
  * @brief Sets the callback for mouse button events.
  * @param wm Pointer to the GLPS Window Manager.
@@ -242,6 +476,31 @@ void glps_wm_get_from_clipboard(glps_WindowManager *wm, char *data,
                                 size_t data_size);
 
 void glps_wm_cursor_change(glps_WindowManager* wm, GLPS_CURSOR_TYPE cursor_type);
+
+/**
+ * @brief Creates a cursor from an RGBA image.
+ *
+ * The cursor is created once and reused by every glps_wm_cursor_set_image()
+ * call with the returned ID.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param rgba Pixels, 4 bytes per pixel in R, G, B, A order, not premultiplied.
+ * @param width Width of the image in pixels.
+ * @param height Height of the image in pixels.
+ * @param hot_x Horizontal offset of the hotspot.
+ * @param hot_y Vertical offset of the hotspot.
+ * @return Cursor ID, or -1 on failure or when image cursors are unsupported.
+ */
+ssize_t glps_wm_cursor_create_image(glps_WindowManager *wm,
+                                    const unsigned char *rgba, int width,
+                                    int height, int hot_x, int hot_y);
+
+/**
+ * @brief Shows a cursor created with glps_wm_cursor_create_image().
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param cursor_id ID returned by glps_wm_cursor_create_image().
+ */
+void glps_wm_cursor_set_image(glps_WindowManager *wm, size_t cursor_id);
 /* ======= Drag & Drop ======= */
 /**
  * @brief Attaches data to Clipboard.
@@ -261,8 +520,179 @@ void glps_wm_start_drag_n_drop(
     void *data);
 
 /* ======= Utilities ======= */
+
+/**
+ * @brief Returns the frame rate of a window averaged over its recent frames.
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @return Frames per second, or 0 until two frames have been drawn.
+ */
 double glps_wm_get_fps(glps_WindowManager *wm, size_t window_id);
 
+/**
+ * @brief Lists the connected outputs.
+ *
+ * The list follows hotplug and mode changes, so refresh rates can be read
+ * again whenever frames are paced.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param outputs Array receiving up to @p max_outputs outputs, may be NULL.
+ * @param max_outputs Capacity of @p outputs.
+ * @return Number of connected outputs, which may exceed @p max_outputs.
+ */
+size_t glps_wm_get_outputs(glps_WindowManager *wm, glps_Output *outputs,
+                           size_t max_outputs);
+
+/**
+ * @brief Returns the output a window is shown on.
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param output Receives the output.
+ * @return false if no output is known.
+ */
+bool glps_wm_window_get_output(glps_WindowManager *wm, size_t window_id,
+                               glps_Output *output);
+
+/**
+ * @brief Chooses the input event classes a window receives.
+ *
+ * Classes left out are not requested from the display server where the
+ * platform allows it: X11 stops selecting them, and Wayland releases seat
+ * devices no window listens to. Display-only windows can pass 0 to receive
+ * no input at all. Windows start with GLPS_EVENT_ALL.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param mask Bitwise OR of GLPS_EVENT_MASK values.
+ */
+void glps_wm_window_set_event_mask(glps_WindowManager *wm, size_t window_id,
+                                   unsigned int mask);
+
+/**
+ * @brief Returns the keyboard and pointer state of a window.
+ *
+ * The state reflects every event dispatched so far, so a frame callback can
+ * poll it instead of mirroring input from callbacks.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @return Copy of the input state.
+ */
+glps_InputState glps_wm_get_input_state(glps_WindowManager *wm,
+                                        size_t window_id);
+
+/**
+ * @brief Tests whether a key is held in an input state.
+ * @param state State returned by glps_wm_get_input_state().
+ * @param keycode Keycode as reported to keyboard_callback.
+ */
+static inline bool glps_input_key_down(const glps_InputState *state,
+                                       unsigned long keycode)
+{
+  return keycode < GLPS_INPUT_KEY_COUNT &&
+         (state->keys[keycode / 64] >> (keycode % 64)) & 1u;
+}
+
+/**
+ * @brief Tests whether a mouse button is held in an input state.
+ * @param state State returned by glps_wm_get_input_state().
+ * @param button Button to test.
+ */
+static inline bool glps_input_button_down(const glps_InputState *state,
+                                          GLPS_MOUSE_BUTTON button)
+{
+  return (state->buttons >> button) & 1u;
+}
+
+/**
+ * @brief Returns a snapshot of the rolling frame-time statistics of a window.
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @return Statistics over the last GLPS_FRAME_STATS_CAPACITY frames.
+ * @note Safe to call from any thread.
+ */
+glps_FrameStats glps_wm_get_frame_stats(glps_WindowManager *wm,
+                                        size_t window_id);
+
+/**
+ * @brief Sets the frame budget used to count frames over budget.
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param budget_ms Frame budget in milliseconds, 0 disables the count.
+ */
+void glps_wm_window_set_frame_budget(glps_WindowManager *wm, size_t window_id,
+                                     double budget_ms);
+
+/**
+ * @brief Enables GPU timing of the frames of a window.
+ *
+ * Each frame is bracketed by GL timestamp queries, from the moment the
+ * window's context is made current to the swap. Results are read back a few
+ * frames later without stalling and reported in glps_FrameStats.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param enabled If true, frames are timed on the GPU.
+ */
+void glps_wm_window_set_gpu_timing(glps_WindowManager *wm, size_t window_id,
+                                   bool enabled);
+
+/**
+ * @brief Renders a window below its size.
+ *
+ * The render size is the window size times @p scale, so every lower scale
+ * yields fewer pixels. On Wayland the EGL buffer is sized to it and the
+ * compositor stretches it back to the window size. Other backends cannot
+ * scale on the server side: the application renders at
+ * glps_wm_window_get_render_dimensions() and upscales the result itself.
+ *
+ * Disables the dynamic resolution controller of the window.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param scale Fraction of the window size to render at, in (0, 1].
+ */
+void glps_wm_window_set_render_scale(glps_WindowManager *wm, size_t window_id,
+                                     double scale);
+
+/**
+ * @brief Returns the render scale of a window.
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @return Fraction of the window size the window renders at.
+ */
+double glps_wm_window_get_render_scale(glps_WindowManager *wm,
+                                       size_t window_id);
+
+/**
+ * @brief Retrieves the size in pixels the window should be rendered at.
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param width Pointer to store the render width.
+ * @param height Pointer to store the render height.
+ */
+void glps_wm_window_get_render_dimensions(glps_WindowManager *wm,
+                                          size_t window_id, int *width,
+                                          int *height);
+
+/**
+ * @brief Lets GLPS lower or raise the render scale of a window to hold a
+ * target frame time.
+ *
+ * The scale moves through a fixed step table with hysteresis: it steps down
+ * after a few frames over the target and back up only after a sustained
+ * period well under it. GPU timing is enabled on the window, since frame
+ * intervals are pinned to the refresh rate under vsync and show no headroom.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param enabled If true, the controller drives the render scale.
+ * @param target_ms Frame time to hold, in milliseconds.
+ */
+void glps_wm_window_set_dynamic_resolution(glps_WindowManager *wm,
+                                           size_t window_id, bool enabled,
+                                           double target_ms);
+
 void *glps_get_proc_addr(const char *name);
 
 void glps_wm_toggle_window_decorations(glps_WindowManager *wm, bool state, size_t window_id);
@@ -10,6 +10,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -39,8 +40,11 @@
 
 // Wayland
 #ifdef GLPS_USE_WAYLAND
+#include "xdg/fractional-scale-v1.h"
+#include "xdg/viewporter.h"
 #include "xdg/wlr-data-control-unstable-v1.h"
 #include "xdg/xdg-decorations.h"
+#include "xdg/xdg-output.h"
 #include "xdg/xdg-shell.h"
 #include "xdg/xdg-toplevel-tag.h"
 #include <EGL/egl.h>
@@ -48,6 +52,7 @@
 #include <sys/mman.h>
 #include <wayland-client-protocol.h>
 #include <wayland-client.h>
+#include <wayland-cursor.h>
 #include <wayland-egl.h>
 #include <xkbcommon/xkbcommon.h>
 #endif
@@ -60,11 +65,24 @@
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 #include <X11/cursorfont.h>
+#include <X11/extensions/sync.h>
+#ifdef GLPS_HAVE_XCURSOR
+#include <X11/Xcursor/Xcursor.h>
+#endif
+#ifdef GLPS_HAVE_XRANDR
+#include <X11/extensions/Xrandr.h>
+#endif
 #include <time.h>
 
 #endif
 
 #define MAX_WINDOWS 100
+#define GLPS_FRAME_STATS_CAPACITY 256 /**< Frames kept in the rolling window. */
+#define GLPS_GPU_TIMER_LATENCY 4      /**< Frames a GPU timer query may stay in flight. */
+#define GLPS_INPUT_KEY_COUNT 512      /**< Keycodes tracked by glps_InputState. */
+#define GLPS_MAX_OUTPUTS 16           /**< Outputs tracked per window manager. */
+#define GLPS_FALLBACK_REFRESH_HZ 60.0 /**< Refresh rate assumed when it is unknown. */
+#define GLPS_MAX_POOLED_WINDOWS 8     /**< Hidden windows kept ready for reuse. */
 
 /**
  * @struct glps_WindowProperties
@@ -77,6 +95,228 @@ typedef struct
   int height;
 } glps_WindowProperties;
 
+/**
+ * @struct glps_FrameStats
+ * @brief Snapshot of the rolling frame-time statistics of a window.
+ *
+ * Frame times are measured between the starts of consecutive frame callbacks.
+ * All durations are in milliseconds.
+ */
+typedef struct
+{
+  uint64_t frame_count;        /**< Frames recorded since the window was created. */
+  size_t sample_count;         /**< Frames covered by this snapshot. */
+  double fps;                  /**< Frame rate derived from the mean frame time. */
+  double mean_ms;              /**< Mean frame time. */
+  double p50_ms;               /**< Median frame time. */
+  double p95_ms;               /**< 95th percentile frame time. */
+  double p99_ms;               /**< 99th percentile frame time. */
+  double max_ms;               /**< Longest frame time. */
+  double jitter_ms;            /**< Mean absolute difference between consecutive frame times. */
+  double budget_ms;            /**< Frame budget the window is measured against. */
+  uint64_t over_budget_frames; /**< Frames over budget since the window was created. */
+  double callback_cpu_ms;      /**< Mean CPU time spent in the frame callback, swap excluded. */
+  double swap_cpu_ms;          /**< Mean CPU time spent swapping buffers. */
+  size_t gpu_sample_count;     /**< Frames with a resolved GPU time, 0 if GPU timing is off. */
+  double gpu_mean_ms;          /**< Mean GPU time from context bind to swap. */
+  double gpu_p95_ms;           /**< 95th percentile GPU time. */
+  double gpu_max_ms;           /**< Longest GPU time. */
+  uint64_t gpu_dropped_frames; /**< Frames left untimed because all queries were in flight. */
+} glps_FrameStats;
+
+/**
+ * @struct glps_FrameSchedule
+ * @brief Scheduling state of a window's next frame.
+ */
+typedef struct
+{
+  bool pending;                /**< Whether a frame is ready to be drawn. */
+  uint64_t deadline_ns;        /**< Weighted deadline frames are ordered by. */
+  uint64_t period_ns;          /**< Refresh period of the window's output. */
+  uint64_t cost_ns;            /**< Smoothed time a frame of the window takes. */
+  uint64_t pass;               /**< Last scheduler pass that put the frame off. */
+  uint64_t deferred_period_ns; /**< Start of the last budget period that put it off. */
+  unsigned int deferred;       /**< Budget periods in a row the frame was put off. */
+} glps_FrameSchedule;
+
+/**
+ * @struct glps_FrameScheduler
+ * @brief Frame budget shared by all windows for one refresh period.
+ */
+typedef struct
+{
+  uint64_t period_start_ns; /**< Start of the current budget period. */
+  uint64_t period_ns;       /**< Length of the current budget period. */
+  uint64_t spent_ns;        /**< Time frames took in the current period. */
+  uint64_t pass;            /**< Number of scheduler passes run. */
+} glps_FrameScheduler;
+
+/**
+ * @struct glps_LoopDesc
+ * @brief Describes the main loop run by glps_wm_run().
+ *
+ * The simulation advances in fixed steps while rendering runs at its own
+ * rate and is handed how far the simulation is between two steps.
+ */
+typedef struct
+{
+  double update_hz;                   /**< Fixed update rate, 60 if 0. */
+  double render_hz;                   /**< Render rate cap, 0 renders on every dispatch and lets vsync pace it. */
+  unsigned int max_updates_per_frame; /**< Steps run before the simulation gives up catching up, 5 if 0. */
+  double idle_slice_ms;               /**< Expected cost of one idle call, 1 ms if 0. */
+  void (*update)(double dt, void *data);      /**< Advances the simulation by @p dt seconds, may be NULL. */
+  void (*render)(double alpha, void *data);   /**< Draws at @p alpha in [0, 1) between the last two steps, may be NULL. */
+  bool (*idle)(void *data);                   /**< Runs one chunk of deferred work, returns true while work remains. May be NULL. */
+  void *data;                                 /**< User data handed to the callbacks. */
+} glps_LoopDesc;
+
+/**
+ * @struct glps_MainLoop
+ * @brief Timing state of a running glps_wm_run().
+ */
+typedef struct
+{
+  glps_LoopDesc desc;          /**< Copy of the loop description. */
+  uint64_t step_ns;            /**< Fixed update step. */
+  uint64_t render_interval_ns; /**< Render period, or measured frame interval when vsync paced. */
+  uint64_t idle_slice_ns;      /**< Time an idle call is expected to take. */
+  uint64_t render_ns;          /**< Smoothed duration of the render callback. */
+  uint64_t last_ns;            /**< Time of the previous tick. */
+  uint64_t accumulator_ns;     /**< Simulation time not yet stepped. */
+  uint64_t last_render_ns;     /**< End of the previous render, 0 before the first. */
+  uint64_t next_render_ns;     /**< Deadline of the next render. */
+} glps_MainLoop;
+
+/**
+ * @struct glps_FrameStatsRing
+ * @brief Lock-free ring of per-frame samples owned by a window.
+ *
+ * Written only by the thread dispatching frame callbacks; snapshots may be
+ * taken from any thread.
+ */
+typedef struct
+{
+  uint64_t frame_ns[GLPS_FRAME_STATS_CAPACITY];    /**< Frame-to-frame intervals. */
+  uint64_t callback_ns[GLPS_FRAME_STATS_CAPACITY]; /**< Callback time, swap excluded. */
+  uint64_t swap_ns[GLPS_FRAME_STATS_CAPACITY];     /**< Swap time. */
+  atomic_uint_fast64_t head;        /**< Number of samples ever written. */
+  atomic_uint_fast64_t over_budget; /**< Frames over budget so far. */
+  atomic_uint_fast64_t budget_ns;   /**< Frame budget, settable from any thread. */
+  uint64_t last_begin_ns;           /**< Start of the previous frame callback. */
+  uint64_t begin_ns;                /**< Start of the current frame callback. */
+  uint64_t pending_swap_ns;         /**< Swap time accumulated during the current frame. */
+  uint64_t gpu_ns[GLPS_FRAME_STATS_CAPACITY]; /**< Resolved GPU frame times. */
+  atomic_uint_fast64_t gpu_head;    /**< Number of GPU samples ever written. */
+  atomic_uint_fast64_t gpu_dropped; /**< Frames left untimed on the GPU. */
+} glps_FrameStatsRing;
+
+/**
+ * @struct glps_GpuTimer
+ * @brief Ring of GL timestamp query pairs bracketing the frames of a window.
+ *
+ * Queries are read back GLPS_GPU_TIMER_LATENCY frames late at most and only
+ * once their results are available, so timing never stalls the pipeline.
+ */
+typedef struct
+{
+  unsigned int begin_queries[GLPS_GPU_TIMER_LATENCY]; /**< Timestamps at context bind. */
+  unsigned int end_queries[GLPS_GPU_TIMER_LATENCY];   /**< Timestamps before swap. */
+  uint64_t issued;   /**< Query pairs ever issued. */
+  uint64_t resolved; /**< Query pairs ever read back. */
+  bool enabled;      /**< Whether frames of the window are timed. */
+  bool created;      /**< Whether the query objects exist. */
+  bool in_frame;     /**< Whether a begin timestamp awaits its end. */
+} glps_GpuTimer;
+
+/**
+ * @struct glps_DynamicResolution
+ * @brief State of the controller adjusting a window's render scale to hold a
+ * target frame time.
+ */
+typedef struct
+{
+  bool enabled;            /**< Whether the controller drives the render scale. */
+  uint64_t target_ns;      /**< Frame time to hold. */
+  size_t step;             /**< Index into the scale step table. */
+  double filtered_ns;      /**< Smoothed frame cost. */
+  uint64_t frame_head;     /**< Last CPU sample consumed. */
+  uint64_t gpu_head;       /**< Last GPU sample consumed. */
+  unsigned int over_count; /**< Consecutive frames above the target. */
+  unsigned int under_count; /**< Consecutive frames with headroom. */
+} glps_DynamicResolution;
+
+/**
+ * @enum GLPS_MOUSE_BUTTON
+ * @brief Mouse buttons tracked in glps_InputState::buttons.
+ */
+typedef enum
+{
+  GLPS_MOUSE_BUTTON_LEFT,    /**< Primary button. */
+  GLPS_MOUSE_BUTTON_RIGHT,   /**< Secondary button. */
+  GLPS_MOUSE_BUTTON_MIDDLE,  /**< Wheel button. */
+  GLPS_MOUSE_BUTTON_BACK,    /**< Side button, usually back. */
+  GLPS_MOUSE_BUTTON_FORWARD, /**< Side button, usually forward. */
+  GLPS_MOUSE_BUTTON_COUNT
+} GLPS_MOUSE_BUTTON;
+
+/**
+ * @enum GLPS_EVENT_MASK
+ * @brief Input event classes a window can subscribe to.
+ */
+typedef enum
+{
+  GLPS_EVENT_POINTER_MOTION = 1 << 0,   /**< Pointer motion. */
+  GLPS_EVENT_POINTER_BUTTON = 1 << 1,   /**< Mouse button presses and releases. */
+  GLPS_EVENT_POINTER_SCROLL = 1 << 2,   /**< Scrolling. */
+  GLPS_EVENT_POINTER_CROSSING = 1 << 3, /**< Pointer entering or leaving. */
+  GLPS_EVENT_KEYBOARD = 1 << 4,         /**< Key presses and releases. */
+  GLPS_EVENT_FOCUS = 1 << 5,            /**< Keyboard focus changes. */
+  GLPS_EVENT_TOUCH = 1 << 6,            /**< Touch points. */
+  GLPS_EVENT_ALL = (1 << 7) - 1         /**< Every class, the default. */
+} GLPS_EVENT_MASK;
+
+/**
+ * @struct glps_InputState
+ * @brief Keyboard and pointer state of a window, updated while events are
+ * dispatched.
+ *
+ * Keys are indexed by the keycode keyboard_callback reports. Scroll values
+ * accumulate for the lifetime of the window; diff two snapshots to get the
+ * scroll of a frame.
+ */
+typedef struct
+{
+  uint64_t keys[GLPS_INPUT_KEY_COUNT / 64]; /**< Pressed keys, one bit per keycode. */
+  uint32_t buttons;     /**< Pressed buttons, one bit per GLPS_MOUSE_BUTTON. */
+  double pointer_x;     /**< Last pointer position in surface coordinates. */
+  double pointer_y;
+  double scroll_x;      /**< Accumulated horizontal scroll. */
+  double scroll_y;      /**< Accumulated vertical scroll. */
+  bool pointer_inside;  /**< Whether the pointer is over the window. */
+  bool keyboard_focus;  /**< Whether the window has keyboard focus. */
+} glps_InputState;
+
+/**
+ * @struct glps_Output
+ * @brief A monitor the windows can be shown on.
+ *
+ * Positions and logical sizes are in the desktop coordinate space; the mode
+ * size is in physical pixels.
+ */
+typedef struct
+{
+  uint32_t id;          /**< Identifier, stable while the output is connected. */
+  char name[64];        /**< Connector name such as "DP-1", may be empty. */
+  int x;                /**< Left edge in desktop coordinates. */
+  int y;                /**< Top edge in desktop coordinates. */
+  int logical_width;    /**< Width in desktop coordinates. */
+  int logical_height;   /**< Height in desktop coordinates. */
+  int width;            /**< Width of the current mode in pixels. */
+  int height;           /**< Height of the current mode in pixels. */
+  double refresh_hz;    /**< Refresh rate of the current mode. */
+  double scale;         /**< Scale factor windows on the output are drawn at. */
+} glps_Output;
+
 /**
  * @enum GLPS_SCROLL_AXES
  * @brief Scroll axis definitions.
@@ -115,6 +355,62 @@ typedef enum {
   GLPS_CURSOR_NOT_ALLOWED
 } GLPS_CURSOR_TYPE;
 
+#define GLPS_CURSOR_TYPE_COUNT (GLPS_CURSOR_NOT_ALLOWED + 1)
+#define GLPS_MAX_CUSTOM_CURSORS 32 /**< Image cursors kept per window manager. */
+#define GLPS_MAX_CURSOR_SCALE 4    /**< Highest integer scale cursors are decoded at. */
+#define GLPS_DEFAULT_CURSOR_SIZE 24 /**< Cursor size when XCURSOR_SIZE is unset. */
+
+/**
+ * @enum GLPS_HIDDEN_REASON
+ * @brief Reasons a window is not visible; a window is visible when none apply.
+ */
+typedef enum
+{
+  GLPS_HIDDEN_UNMAPPED = 1 << 0,  /**< Window is unmapped. */
+  GLPS_HIDDEN_OBSCURED = 1 << 1,  /**< Window is fully covered by others. */
+  GLPS_HIDDEN_MINIMIZED = 1 << 2, /**< Window is minimized. */
+  GLPS_HIDDEN_SUSPENDED = 1 << 3, /**< Compositor suspended the window. */
+  GLPS_HIDDEN_STALLED = 1 << 4    /**< Compositor stopped sending frame callbacks. */
+} GLPS_HIDDEN_REASON;
+
+/**
+ * @enum GLPS_RENDER_MODE
+ * @brief When frame callbacks of a window are dispatched.
+ */
+typedef enum
+{
+  GLPS_RENDER_CONTINUOUS, /**< Every frame. */
+  GLPS_RENDER_ON_DEMAND   /**< Only after a redraw request, input or resize. */
+} GLPS_RENDER_MODE;
+
+/**
+ * @enum GLPS_WINDOW_ROLE
+ * @brief How a window is placed and managed.
+ */
+typedef enum
+{
+  GLPS_WINDOW_TOPLEVEL,  /**< Window managed by the compositor. */
+  GLPS_WINDOW_POPUP,     /**< Menu or tooltip placed relative to a parent. */
+  GLPS_WINDOW_SUBSURFACE /**< Layer composited inside a parent window. */
+} GLPS_WINDOW_ROLE;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+#include "glps_thread.h"
+
+/**
+ * @struct glps_EventReader
+ * @brief Thread reading the display connection while the UI thread renders.
+ */
+typedef struct
+{
+  gthread_t thread;    /**< Reader thread. */
+  bool running;        /**< Whether @ref thread was started, UI thread only. */
+  atomic_bool stop;    /**< Asks the reader thread to exit. */
+  atomic_bool failed;  /**< Set by the reader when the connection broke. */
+  int wake_fds[2];     /**< Pipe interrupting the reader's poll. */
+} glps_EventReader;
+#endif
+
 struct glps_Callback
 {
   void (*keyboard_enter_callback)(
@@ -149,6 +445,12 @@ struct glps_Callback
       size_t window_id, void *data); /**< Callback for window close event. */
   void (*window_frame_update_callback)(
       size_t window_id, void *data); /**< Callback for window update event. */
+  void (*window_visibility_callback)(
+      size_t window_id, bool visible,
+      void *data); /**< Callback for visibility changes. */
+  void (*late_latch_callback)(
+      size_t window_id, double mouse_x, double mouse_y,
+      void *data); /**< Callback right before a swap, with the freshest pointer position. */
 
   void *mouse_enter_data;
   void *mouse_leave_data;
@@ -163,6 +465,8 @@ struct glps_Callback
   void *window_resize_data;
   void *window_frame_update_data;
   void *window_close_data;
+  void *window_visibility_data;
+  void *late_latch_data;
 };
 
 #ifdef GLPS_USE_WAYLAND
@@ -254,7 +558,7 @@ struct touch_event
  * @struct glps_WaylandWindow
  * @brief Represents a Wayland window in GLPS.
  */
-typedef struct
+typedef struct glps_WaylandWindow
 {
   struct xdg_surface *xdg_surface;   /**< XDG surface. */
   struct xdg_toplevel *xdg_toplevel; /**< XDG toplevel. */
@@ -265,13 +569,47 @@ typedef struct
   glps_WindowProperties properties; /**< Window properties. */
   struct zxdg_toplevel_decoration_v1 *zxdg_toplevel_decoration;
   struct wl_callback *frame_callback;
-  // FPS COUNTER
-  struct timespec fps_start_time;
-  bool fps_is_init;
+  glps_FrameStatsRing frame_stats; /**< Rolling frame-time statistics. */
+  glps_GpuTimer gpu_timer;         /**< GPU frame timing queries. */
+  glps_DynamicResolution dynamic_resolution; /**< Render scale controller. */
+  glps_FrameSchedule schedule;     /**< Place of the window's next frame in the scheduler. */
   void *frame_args;
-  uint32_t serial;
+  uint32_t serial;        /**< Serial of the latest xdg_surface configure. */
+  bool configure_pending; /**< Whether @ref serial still awaits its ack. */
+  int pending_width;      /**< Latest configured width, 0 if unset. */
+  int pending_height;     /**< Latest configured height, 0 if unset. */
+  unsigned int hidden_reasons;  /**< GLPS_HIDDEN_REASON flags, 0 when visible. */
+  uint64_t last_frame_done_ns;  /**< When the compositor last sent a frame callback. */
+  GLPS_RENDER_MODE render_mode; /**< When frame callbacks are dispatched. */
+  bool redraw_requested;        /**< Whether the next frame callback should draw. */
+  struct wp_viewport *viewport;                   /**< Scales the buffer to the logical size. */
+  struct wp_fractional_scale_v1 *fractional_scale; /**< Preferred scale notifications. */
+  double render_scale;    /**< Requested fraction of the window size to render at. */
+  double preferred_scale; /**< Output scale preferred by the compositor. */
+  int buffer_width;       /**< Width of the EGL buffer in pixels. */
+  int buffer_height;      /**< Height of the EGL buffer in pixels. */
+  uint32_t output_id;     /**< Output the surface last entered, 0 if none. */
+  glps_InputState input;  /**< Keyboard and pointer state. */
+  unsigned int event_mask; /**< GLPS_EVENT_MASK classes the window receives. */
+  bool awaiting_map;      /**< Initial configure not yet acked. */
+  GLPS_WINDOW_ROLE role;  /**< Which of the role objects below exist. */
+  struct xdg_popup *xdg_popup;      /**< Popup role, NULL for other roles. */
+  struct wl_subsurface *subsurface; /**< Subsurface role, NULL for other roles. */
+  struct glps_WaylandWindow *parent; /**< Window attached to, NULL for toplevels. */
 } glps_WaylandWindow;
 
+/**
+ * @struct glps_WaylandOutput
+ * @brief A bound wl_output and the state its events describe.
+ */
+typedef struct
+{
+  struct wl_output *wl_output;       /**< Bound output. */
+  struct zxdg_output_v1 *xdg_output; /**< Logical geometry, may be NULL. */
+  glps_Output info;                  /**< Last state published by a done event. */
+  glps_Output pending;               /**< State accumulated until the next done. */
+} glps_WaylandOutput;
+
 typedef struct
 {
   int x; // X coordinate of the drop
@@ -287,11 +625,19 @@ typedef struct
   struct wl_display *wl_display;       /**< Wayland display. */
   struct wl_registry *wl_registry;     /**< Wayland registry. */
   struct wl_compositor *wl_compositor; /**< Wayland compositor. */
+  uint32_t compositor_version;         /**< Bound wl_compositor version. */
+  struct wl_subcompositor *subcompositor; /**< Subsurface support, may be NULL. */
   struct wl_seat *wl_seat;             /**< Wayland seat. */
   struct xdg_wm_base *xdg_wm_base;     /**< XDG WM base. */
   struct zxdg_decoration_manager_v1
       *decoration_manager;                         /**< Decoration manager. */
   struct xdg_toplevel_tag_manager_v1 *tag_manager; /**< Tag manager. */
+  struct wp_viewporter *viewporter;                /**< Viewport scaling, may be NULL. */
+  struct wp_fractional_scale_manager_v1
+      *fractional_scale_manager;                   /**< Fractional scale, may be NULL. */
+  struct zxdg_output_manager_v1 *xdg_output_manager; /**< Logical output geometry, may be NULL. */
+  glps_WaylandOutput outputs[GLPS_MAX_OUTPUTS];    /**< Connected outputs. */
+  size_t output_count;                             /**< Number of entries in @ref outputs. */
   struct wl_data_device_manager *data_dvc_manager; /**< Data control Manager. */
   struct wl_data_device *data_dvc;                 /**< Data device to interact with Clipboard
                                                       and Drag&Drop operations. */
@@ -302,9 +648,29 @@ typedef struct
   struct xkb_context *xkb_context;                 /**< Keyboard context. */
   struct xkb_keymap *xkb_keymap;                   /**< Keyboard keymap. */
   struct wl_touch *wl_touch;                       /**< Wayland touch interface. */
+  struct wl_shm *wl_shm;                           /**< Shared memory for cursor buffers. */
+  struct wl_cursor_theme *cursor_themes[GLPS_MAX_CURSOR_SCALE]; /**< Themes per scale, loaded on demand. */
+  struct wl_cursor *cursors[GLPS_MAX_CURSOR_SCALE][GLPS_CURSOR_TYPE_COUNT]; /**< Cursors looked up so far. */
+  struct wl_surface *cursor_surface;               /**< Surface showing the seat's cursor. */
+  struct wl_callback *cursor_frame_callback;       /**< Drives animated cursors. */
+  struct wl_cursor *cursor;                        /**< Cursor attached to @ref cursor_surface. */
+  GLPS_CURSOR_TYPE cursor_type;                    /**< Cursor selected by the application. */
+  int cursor_scale;                                /**< Scale of the attached cursor buffer. */
+  int cursor_hotspot_x;                            /**< Hotspot sent with the last set_cursor. */
+  int cursor_hotspot_y;
+  unsigned int cursor_frame;                       /**< Attached image of an animated cursor. */
+  uint32_t cursor_start_ms;                        /**< Time the animation started, 0 if not yet. */
+  uint32_t pointer_enter_serial;                   /**< Serial of the last pointer enter, 0 outside. */
+  uint32_t seat_capabilities;                      /**< Devices the seat offers. */
+  glps_WaylandWindow *pool[GLPS_MAX_POOLED_WINDOWS]; /**< Unmapped windows ready for reuse. */
+  size_t pool_count;                               /**< Number of entries in @ref pool. */
+  size_t pool_capacity;                            /**< Windows the pool is kept filled to. */
+  glps_EventReader reader;                         /**< Socket reader, if the event thread is on. */
+  struct wl_event_queue *reader_queue;             /**< Private queue the reader prepares reads on. */
   struct wl_data_offer *current_drag_offer;
   uint32_t current_serial;
   uint32_t keyboard_serial;
+  uint32_t press_serial;                           /**< Serial of the last button, key or touch press. */
   size_t keyboard_window_id;
   size_t mouse_window_id;
   size_t touch_window_id;
@@ -336,9 +702,16 @@ typedef struct
   HWND hwnd;
   HDC hdc;
   glps_WindowProperties properties;
-  LARGE_INTEGER fps_start_time;
-  LARGE_INTEGER fps_freq;
-  bool fps_is_init;
+  glps_FrameStatsRing frame_stats; /**< Rolling frame-time statistics. */
+  glps_GpuTimer gpu_timer;         /**< GPU frame timing queries. */
+  glps_DynamicResolution dynamic_resolution; /**< Render scale controller. */
+  glps_FrameSchedule schedule;     /**< Place of the window's next frame in the scheduler. */
+  double render_scale;             /**< Fraction of the window size to render at. */
+  unsigned int hidden_reasons;     /**< GLPS_HIDDEN_REASON flags, 0 when visible. */
+  GLPS_RENDER_MODE render_mode;    /**< When frame callbacks are dispatched. */
+  bool redraw_requested;           /**< Whether a redraw is pending. */
+  glps_InputState input;           /**< Keyboard and pointer state. */
+  unsigned int event_mask;         /**< GLPS_EVENT_MASK classes the window receives. */
 } glps_Win32Window;
 
 typedef struct
@@ -352,13 +725,45 @@ typedef struct
 
 #ifdef GLPS_USE_X11
 
+#define GLPS_X11_EVENT_RING_CAPACITY 256 /**< Events buffered by the reader thread. */
+
+/**
+ * @struct glps_X11EventRing
+ * @brief Single-producer single-consumer queue of events read off the
+ * connection by the reader thread.
+ */
+typedef struct
+{
+  XEvent events[GLPS_X11_EVENT_RING_CAPACITY];
+  atomic_size_t head; /**< Next slot the reader writes. */
+  atomic_size_t tail; /**< Next slot the UI thread reads. */
+} glps_X11EventRing;
+
 typedef struct
 {
   Display *display;      /**< X11 display connection. */
   GC gc;                 /**< Graphics context for rendering. */
   Atom wm_delete_window; /**< Atom for handling window close events. */
   XFontStruct *font;     /**< X11 font structure for text rendering. */
-  Cursor cursor;
+  Cursor cursor;                   /**< Cursor selected for all windows. */
+  Cursor cursor_cache[GLPS_CURSOR_TYPE_COUNT]; /**< Font cursors, None until first used. */
+  Cursor custom_cursors[GLPS_MAX_CUSTOM_CURSORS]; /**< Cursors created from images. */
+  size_t custom_cursor_count;      /**< Number of entries in @ref custom_cursors. */
+  bool has_xsync;                  /**< Whether the XSync extension is available. */
+  Atom net_wm_sync_request;         /**< _NET_WM_SYNC_REQUEST protocol atom. */
+  Atom net_wm_sync_request_counter; /**< _NET_WM_SYNC_REQUEST_COUNTER property atom. */
+  Atom net_wm_state;                /**< _NET_WM_STATE property atom. */
+  Atom net_wm_state_hidden;         /**< _NET_WM_STATE_HIDDEN state atom. */
+  Atom motif_wm_hints;              /**< _MOTIF_WM_HINTS property atom. */
+  Atom net_wm_window_type;          /**< _NET_WM_WINDOW_TYPE property atom. */
+  Atom net_wm_window_type_normal;   /**< _NET_WM_WINDOW_TYPE_NORMAL type atom. */
+  Atom net_wm_window_type_dock;     /**< _NET_WM_WINDOW_TYPE_DOCK type atom. */
+  bool has_xrandr;                  /**< Whether outputs are tracked through XRandR. */
+  int xrandr_event_base;            /**< First XRandR event code. */
+  glps_Output outputs[GLPS_MAX_OUTPUTS]; /**< Connected outputs. */
+  size_t output_count;              /**< Number of entries in @ref outputs. */
+  glps_EventReader reader;          /**< Connection reader, if the event thread is on. */
+  glps_X11EventRing events;         /**< Events handed over by @ref reader. */
 } glps_X11Context;
 
 typedef struct
@@ -366,7 +771,28 @@ typedef struct
   EGLSurface egl_surface;           /**< EGL surface. */
   struct wl_egl_window *egl_window; /**< X11 EGL window. */
   Window window;                    /**< X11 window identifier. */
-  bool fps_is_init;
+  glps_WindowProperties properties; /**< Size as of the last ConfigureNotify. */
+  int x;                            /**< Root-relative position of the window. */
+  int y;                            /**< Root-relative position of the window. */
+  bool reparented;                  /**< Whether a window manager frame owns the window. */
+  bool resizable;                   /**< Resize hint last set on the window. */
+  GLPS_WINDOW_ROLE role;            /**< Toplevel, override-redirect popup or child window. */
+  Window parent;                    /**< Window the popup or child belongs to, None for toplevels. */
+  bool grab;                        /**< Whether the popup holds the pointer and keyboard grab. */
+  glps_FrameStatsRing frame_stats;  /**< Rolling frame-time statistics. */
+  glps_GpuTimer gpu_timer;          /**< GPU frame timing queries. */
+  glps_DynamicResolution dynamic_resolution; /**< Render scale controller. */
+  glps_FrameSchedule schedule;      /**< Place of the window's next frame in the scheduler. */
+  double render_scale;              /**< Fraction of the window size to render at. */
+  XSyncCounter sync_counter;        /**< _NET_WM_SYNC_REQUEST counter, None if unsupported. */
+  XSyncValue sync_value;            /**< Value to publish once the resized frame is shown. */
+  int sync_state;                   /**< GLPS_X11_SYNC_* progress of the pending request. */
+  unsigned int hidden_reasons;      /**< GLPS_HIDDEN_REASON flags, 0 when visible. */
+  GLPS_RENDER_MODE render_mode;     /**< When frame callbacks are dispatched. */
+  bool redraw_requested;            /**< Whether a redraw is pending. */
+  Cursor defined_cursor;            /**< Cursor last defined on the window. */
+  glps_InputState input;            /**< Keyboard and pointer state. */
+  unsigned int event_mask;          /**< GLPS_EVENT_MASK classes the window receives. */
 
 } glps_X11Window;
 
@@ -383,6 +809,89 @@ struct glps_debug
   bool enable_fps_counter;
 };
 
+#define GLPS_EVENT_LOOP_BATCH 64 /**< Posted tasks run per dispatch at most. */
+#define GLPS_MAX_FD_WATCHES 32   /**< User descriptors watched per window manager. */
+
+/**
+ * @enum GLPS_FD_EVENT
+ * @brief Readiness of a descriptor registered with glps_wm_add_fd().
+ */
+typedef enum
+{
+  GLPS_FD_READABLE = 1 << 0, /**< Data can be read without blocking. */
+  GLPS_FD_WRITABLE = 1 << 1, /**< Data can be written without blocking. */
+  GLPS_FD_ERROR = 1 << 2     /**< Error or hangup, always reported. */
+} GLPS_FD_EVENT;
+
+/**
+ * @struct glps_FdWatch
+ * @brief A user descriptor polled together with the display connection.
+ */
+typedef struct
+{
+  int fd;              /**< Watched descriptor, -1 for a free slot. */
+  unsigned int events; /**< GLPS_FD_EVENT flags to wait for. */
+  unsigned int ready;  /**< GLPS_FD_EVENT flags seen by the last poll. */
+  void (*callback)(int fd, unsigned int events, void *data); /**< Called when ready. */
+  void *data;          /**< User data handed to @ref callback. */
+} glps_FdWatch;
+
+/**
+ * @struct glps_Task
+ * @brief A function posted to the event thread, linked into the task queue.
+ */
+typedef struct glps_Task
+{
+  _Atomic(struct glps_Task *) next; /**< Next task in posting order. */
+  void (*fn)(void *arg);            /**< Function to run. */
+  void *arg;                        /**< Argument handed to @ref fn. */
+} glps_Task;
+
+/**
+ * @struct glps_EventLoop
+ * @brief Lock-free multi-producer, single-consumer task queue and the handle
+ * that wakes the event thread when tasks are posted.
+ */
+typedef struct
+{
+  _Atomic(glps_Task *) head; /**< Last posted task, producers swap it. */
+  glps_Task *tail;           /**< Next task to run, owned by the event thread. */
+  glps_Task stub;            /**< Placeholder keeping the queue non-empty. */
+  atomic_size_t pending;     /**< Tasks posted and not run yet. */
+  atomic_bool wake_pending;  /**< Whether a wakeup was signalled and not consumed. */
+#ifdef GLPS_USE_WIN32
+  HANDLE wake_event;         /**< Auto-reset event waited on with the message queue. */
+#else
+  int wake_fd;               /**< Readable while tasks are pending, -1 if unavailable. */
+  int wake_write_fd;         /**< Written to wake, same as @ref wake_fd for an eventfd. */
+  glps_FdWatch watches[GLPS_MAX_FD_WATCHES]; /**< Registered user descriptors. */
+  size_t watch_count;        /**< Slots of @ref watches in use, free ones included. */
+  bool polled;               /**< Whether the backend polled the watches this dispatch. */
+#endif
+} glps_EventLoop;
+
+/**
+ * @enum GLPS_STAT
+ * @brief Process-wide counters published on the stats page.
+ */
+typedef enum
+{
+  GLPS_STAT_COALESCED_EVENTS, /**< Input events merged into a later one. */
+  GLPS_STAT_AUDIO_XRUNS,      /**< Audio buffer underruns. */
+  GLPS_STAT_COUNT
+} GLPS_STAT;
+
+/**
+ * @struct glps_StatsPublisher
+ * @brief Shared-memory page the window manager publishes its counters to.
+ */
+typedef struct
+{
+  struct glps_StatsPage *page; /**< Mapped page, NULL while not publishing. */
+  int fd;                      /**< memfd backing @ref page. */
+  uint64_t last_publish_ns;    /**< Time of the last publish. */
+} glps_StatsPublisher;
+
 /**
  * @struct glps_WindowManager
  * @brief Represents the manager for GLPS windows.
@@ -418,6 +927,11 @@ typedef struct
   struct glps_debug debug_utilities;
   struct glps_Callback callbacks;
   bool should_close;
+  glps_EventLoop event_loop; /**< Tasks posted from other threads. */
+  int wait_timeout_ms;       /**< Longest wait for events in a dispatch, -1 for no limit. */
+  bool latching;             /**< Whether input is being latched before a swap. */
+  glps_FrameScheduler scheduler; /**< Orders frame callbacks across windows. */
+  glps_StatsPublisher stats;     /**< Live statistics page, if enabled. */
 
 } glps_WindowManager;
 
@@ -0,0 +1,56 @@
+/**
+ * @file glps_dynamic_resolution.h
+ * @brief Controller lowering or raising a window's render scale to hold a
+ * target frame time.
+ */
+
+#ifndef GLPS_DYNAMIC_RESOLUTION_H
+#define GLPS_DYNAMIC_RESOLUTION_H
+
+#include "glps_common.h"
+
+/**
+ * @brief Starts driving the render scale from full resolution.
+ * @param dr Controller state of the window.
+ * @param target_ns Frame time to hold.
+ */
+void glps_dynamic_resolution_start(glps_DynamicResolution *dr,
+                                   uint64_t target_ns);
+
+/**
+ * @brief Feeds the samples recorded since the last update to the controller.
+ *
+ * GPU times are preferred when the window is GPU-timed, since frame intervals
+ * are pinned to the refresh rate under vsync and show no headroom. Updates
+ * without a new GPU time use the frame interval.
+ *
+ * @param dr Controller state of the window.
+ * @param ring Frame statistics of the window.
+ * @param scale Receives the new render scale when it changes.
+ * @return true if the render scale changed.
+ */
+bool glps_dynamic_resolution_update(glps_DynamicResolution *dr,
+                                    glps_FrameStatsRing *ring, double *scale);
+
+/**
+ * @brief Returns the render scale of the controller's current step.
+ * @param dr Controller state of the window.
+ */
+double glps_dynamic_resolution_scale(const glps_DynamicResolution *dr);
+
+/**
+ * @brief Computes the size of the buffer a window renders into at a scale.
+ *
+ * The buffer is the logical size times @p scale, so a lower scale never
+ * yields more pixels.
+ *
+ * @param width Logical width of the window.
+ * @param height Logical height of the window.
+ * @param scale Render scale of the window.
+ * @param buffer_width Receives the buffer width, at least 1 if @p width is.
+ * @param buffer_height Receives the buffer height, at least 1 if @p height is.
+ */
+void glps_dynamic_resolution_buffer_size(int width, int height, double scale,
+                                         int *buffer_width, int *buffer_height);
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * @file glps_event_loop.h
+ * @brief Tasks posted to the event thread from any thread.
+ */
+
+#ifndef GLPS_EVENT_LOOP_H
+#define GLPS_EVENT_LOOP_H
+
+#include "glps_common.h"
+
+/**
+ * @brief Sets up an empty queue and its wakeup handle.
+ * @param loop Loop to initialize.
+ * @return false if the wakeup handle could not be created. Posting still
+ * works then, but tasks only run when the event thread wakes on its own.
+ */
+bool glps_event_loop_init(glps_EventLoop *loop);
+
+/**
+ * @brief Frees pending tasks without running them and closes the wakeup handle.
+ * @param loop Loop to tear down.
+ */
+void glps_event_loop_destroy(glps_EventLoop *loop);
+
+/**
+ * @brief Queues a task and wakes the event thread. Safe from any thread.
+ * @param loop Loop of the window manager.
+ * @param fn Function to run on the event thread.
+ * @param arg Argument handed to @p fn.
+ * @return false if the task could not be allocated.
+ */
+bool glps_event_loop_post(glps_EventLoop *loop, void (*fn)(void *), void *arg);
+
+/**
+ * @brief Calls back ready watches, then runs up to GLPS_EVENT_LOOP_BATCH
+ * pending tasks on the event thread.
+ *
+ * Watches the backend didn't poll since the last run are checked without
+ * blocking. When more tasks are left the wakeup stays signalled, so the
+ * next wait returns at once and a flood of tasks can't starve rendering.
+ *
+ * @param loop Loop of the window manager.
+ * @return Number of tasks run.
+ */
+size_t glps_event_loop_run(glps_EventLoop *loop);
+
+#ifdef GLPS_USE_WIN32
+/**
+ * @brief Returns the event to wait on together with the message queue.
+ * @param loop Loop of the window manager.
+ * @return The event, or NULL if there is none.
+ */
+HANDLE glps_event_loop_handle(const glps_EventLoop *loop);
+#else
+/**
+ * @brief Starts watching a descriptor, or updates the watch on it.
+ * @param loop Loop of the window manager.
+ * @param fd Descriptor to watch.
+ * @param events GLPS_FD_EVENT flags to wait for.
+ * @param callback Called on the event thread when the descriptor is ready.
+ * @param data User data handed to @p callback.
+ * @return false if all GLPS_MAX_FD_WATCHES slots are taken.
+ */
+bool glps_event_loop_add_fd(glps_EventLoop *loop, int fd, unsigned int events,
+                            void (*callback)(int fd, unsigned int events,
+                                             void *data),
+                            void *data);
+
+/**
+ * @brief Stops watching a descriptor. Safe from within watch callbacks.
+ * @param loop Loop of the window manager.
+ * @param fd Descriptor to forget.
+ */
+void glps_event_loop_remove_fd(glps_EventLoop *loop, int fd);
+
+/**
+ * @brief Waits for the display, posted tasks and watched descriptors.
+ *
+ * Readiness of the watches is recorded and their callbacks run from the next
+ * glps_event_loop_run(), once the backend is done reading the display.
+ *
+ * @param loop Loop of the window manager.
+ * @param display_fd Display connection, or -1 to poll the watches only.
+ * @param timeout_ms Timeout as for poll(), -1 to wait indefinitely.
+ * @return poll() revents of @p display_fd, or -1 with errno set on failure.
+ */
+int glps_event_loop_poll(glps_EventLoop *loop, int display_fd, int timeout_ms);
+
+/**
+ * @brief Wakes the event thread, e.g. after another thread queued events.
+ * @param loop Loop of the window manager.
+ */
+void glps_event_loop_wake(glps_EventLoop *loop);
+
+/**
+ * @brief Starts a display reader thread.
+ * @param reader Reader to start, not running.
+ * @param body Thread function; it loops until glps_event_reader_should_stop().
+ * @param arg Argument handed to @p body.
+ * @return false if the thread or its wakeup pipe could not be created.
+ */
+bool glps_event_reader_start(glps_EventReader *reader, void *(*body)(void *),
+                             void *arg);
+
+/**
+ * @brief Asks a reader thread to exit and joins it.
+ * @param reader Running reader.
+ */
+void glps_event_reader_stop(glps_EventReader *reader);
+
+/**
+ * @brief Interrupts the reader's current wait.
+ * @param reader Running reader.
+ */
+void glps_event_reader_wake(glps_EventReader *reader);
+
+/**
+ * @brief Waits on the reader thread until the display is readable or the
+ * reader is woken.
+ * @param reader Running reader.
+ * @param display_fd Display connection.
+ * @return true if the display is readable.
+ */
+bool glps_event_reader_wait(glps_EventReader *reader, int display_fd);
+
+/**
+ * @brief Whether the reader thread was asked to exit.
+ * @param reader Running reader.
+ */
+bool glps_event_reader_should_stop(glps_EventReader *reader);
+#endif
+
+#endif
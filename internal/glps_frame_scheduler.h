@@ -0,0 +1,37 @@
+/**
+ * @file glps_frame_scheduler.h
+ * @brief Earliest-deadline-first ordering of frame callbacks across windows.
+ *
+ * Backends mark a window ready when its next frame may be drawn; the frames
+ * then run after event dispatch, focused windows first, and background
+ * windows are put off while the frame budget of the period is spent.
+ */
+
+#ifndef GLPS_FRAME_SCHEDULER_H
+#define GLPS_FRAME_SCHEDULER_H
+
+#include "glps_common.h"
+
+/**
+ * @brief Marks the next frame of a window as ready to be drawn.
+ * @param wm Window manager.
+ * @param window_id Window whose frame callback may run.
+ */
+void glps_frame_scheduler_ready(glps_WindowManager *wm, size_t window_id);
+
+/**
+ * @brief Runs the ready frames in deadline order within the frame budget.
+ * @param wm Window manager.
+ * @return Number of frame callbacks run.
+ */
+size_t glps_frame_scheduler_run(glps_WindowManager *wm);
+
+/**
+ * @brief Returns how long the next dispatch may sleep without delaying a put
+ * off frame.
+ * @param wm Window manager.
+ * @return Milliseconds until the next budget period, -1 if no frame waits.
+ */
+int glps_frame_scheduler_timeout_ms(glps_WindowManager *wm);
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file glps_frame_stats.h
+ * @brief Per-window rolling frame-time statistics.
+ */
+
+#ifndef GLPS_FRAME_STATS_H
+#define GLPS_FRAME_STATS_H
+
+#include "glps_common.h"
+
+#define GLPS_DEFAULT_FRAME_BUDGET_NS (1000000000ull / 60)
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+uint64_t glps_frame_stats_now_ns(void);
+
+/**
+ * @brief Converts a wait to a poll timeout in milliseconds.
+ *
+ * Rounds up, so a wait under a millisecond doesn't become a busy poll.
+ *
+ * @param wait_ns Time to wait.
+ * @return Timeout in whole milliseconds, at most INT_MAX.
+ */
+int glps_frame_stats_timeout_ms(uint64_t wait_ns);
+
+/**
+ * @brief Resets a ring to its initial state with the default frame budget.
+ * @param ring Ring to reset.
+ */
+void glps_frame_stats_init(glps_FrameStatsRing *ring);
+
+/**
+ * @brief Marks the start of a frame callback.
+ * @param ring Ring of the window being drawn.
+ */
+void glps_frame_stats_begin(glps_FrameStatsRing *ring);
+
+/**
+ * @brief Marks the end of a frame callback and publishes the sample.
+ * @param ring Ring of the window being drawn.
+ */
+void glps_frame_stats_end(glps_FrameStatsRing *ring);
+
+/**
+ * @brief Accounts time spent swapping buffers to the current frame.
+ * @param ring Ring of the window being swapped.
+ * @param swap_ns Duration of the swap in nanoseconds.
+ */
+void glps_frame_stats_add_swap(glps_FrameStatsRing *ring, uint64_t swap_ns);
+
+/**
+ * @brief Publishes the GPU time of a frame resolved from timer queries.
+ * @param ring Ring of the window that was timed.
+ * @param gpu_ns GPU time of the frame in nanoseconds.
+ */
+void glps_frame_stats_add_gpu(glps_FrameStatsRing *ring, uint64_t gpu_ns);
+
+/**
+ * @brief Counts a frame that could not be timed on the GPU.
+ * @param ring Ring of the window that was skipped.
+ */
+void glps_frame_stats_drop_gpu(glps_FrameStatsRing *ring);
+
+/**
+ * @brief Computes a statistics snapshot from a ring.
+ * @param ring Ring to read; may be written concurrently.
+ * @param stats Output snapshot.
+ */
+void glps_frame_stats_snapshot(glps_FrameStatsRing *ring,
+                               glps_FrameStats *stats);
+
+/**
+ * @brief Counts the recent frame times of a ring per bucket.
+ * @param ring Ring to read; may be written concurrently.
+ * @param edges_ns Ascending upper bounds of all buckets but the last.
+ * @param bucket_count Number of buckets, one more than edges.
+ * @param counts Output, frames per bucket.
+ */
+void glps_frame_stats_histogram(glps_FrameStatsRing *ring,
+                                const uint64_t *edges_ns, size_t bucket_count,
+                                uint32_t *counts);
+
+#endif
@@ -0,0 +1,43 @@
+/**
+ * @file glps_gpu_timer.h
+ * @brief Non-blocking GPU frame timing with GL timestamp queries.
+ */
+
+#ifndef GLPS_GPU_TIMER_H
+#define GLPS_GPU_TIMER_H
+
+#include "glps_common.h"
+
+/**
+ * @brief Loads the timer query entry points through glps_get_proc_addr().
+ * @return true if the current context supports timestamp queries.
+ * @note Requires a current GL context the first time it is called.
+ */
+bool glps_gpu_timer_load(void);
+
+/**
+ * @brief Reads back finished queries and records the start of a frame.
+ *
+ * Called after every swap, so applications that bind their context only
+ * once still time each frame, and again when the context is made current,
+ * which moves the start of a frame already begun to that point.
+ *
+ * @param timer Timer of the window whose context is current.
+ * @param ring Ring receiving resolved GPU times.
+ */
+void glps_gpu_timer_begin(glps_GpuTimer *timer, glps_FrameStatsRing *ring);
+
+/**
+ * @brief Records the end of the frame started with glps_gpu_timer_begin().
+ * @param timer Timer of the window about to be swapped.
+ */
+void glps_gpu_timer_end(glps_GpuTimer *timer);
+
+/**
+ * @brief Deletes the queries of a timer and leaves it disabled.
+ * @param timer Timer of a window being destroyed or pooled.
+ * @note The GL context the queries were created in must be current.
+ */
+void glps_gpu_timer_destroy(glps_GpuTimer *timer);
+
+#endif
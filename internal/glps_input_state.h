@@ -0,0 +1,54 @@
+/**
+ * @file glps_input_state.h
+ * @brief Maintenance of the per-window input snapshot.
+ */
+
+#ifndef GLPS_INPUT_STATE_H
+#define GLPS_INPUT_STATE_H
+
+#include "glps_common.h"
+
+/**
+ * @brief Records a key press or release.
+ * @param state Input state of the window.
+ * @param keycode Keycode as reported to keyboard_callback.
+ * @param pressed Whether the key went down.
+ */
+void glps_input_state_key(glps_InputState *state, unsigned long keycode,
+                          bool pressed);
+
+/**
+ * @brief Records a mouse button press or release.
+ * @param state Input state of the window.
+ * @param button Button that changed.
+ * @param pressed Whether the button went down.
+ */
+void glps_input_state_button(glps_InputState *state, GLPS_MOUSE_BUTTON button,
+                             bool pressed);
+
+/**
+ * @brief Records the pointer position.
+ * @param state Input state of the window.
+ * @param x Horizontal position in surface coordinates.
+ * @param y Vertical position in surface coordinates.
+ */
+void glps_input_state_motion(glps_InputState *state, double x, double y);
+
+/**
+ * @brief Adds to the scroll accumulators.
+ * @param state Input state of the window.
+ * @param axis Axis scrolled along.
+ * @param value Scroll amount, as reported to mouse_scroll_callback.
+ */
+void glps_input_state_scroll(glps_InputState *state, GLPS_SCROLL_AXES axis,
+                             double value);
+
+/**
+ * @brief Records keyboard focus changes. Losing focus releases all keys,
+ * since their release events go to another window.
+ * @param state Input state of the window.
+ * @param focused Whether the window gained focus.
+ */
+void glps_input_state_focus(glps_InputState *state, bool focused);
+
+#endif
@@ -0,0 +1,27 @@
+/**
+ * @file glps_main_loop.h
+ * @brief Fixed-timestep update, interpolated render and deadline-bounded idle
+ * work behind glps_wm_run().
+ */
+
+#ifndef GLPS_MAIN_LOOP_H
+#define GLPS_MAIN_LOOP_H
+
+#include "glps_common.h"
+
+/**
+ * @brief Prepares a loop for its first tick, filling in defaults.
+ * @param loop Loop state.
+ * @param desc Loop description, copied.
+ */
+void glps_main_loop_init(glps_MainLoop *loop, const glps_LoopDesc *desc);
+
+/**
+ * @brief Runs the updates and the render that are due, then idle work until
+ * the next render deadline.
+ * @param loop Loop state.
+ * @return Nanoseconds left until the next render is due, 0 if it is due.
+ */
+uint64_t glps_main_loop_tick(glps_MainLoop *loop);
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * @file glps_stats.h
+ * @brief Process-wide counters and the shared-memory page they are
+ * published on.
+ */
+
+#ifndef GLPS_STATS_H
+#define GLPS_STATS_H
+
+#include "glps_common.h"
+#include "glps_stats_page.h"
+
+#define GLPS_STATS_PUBLISH_NS 250000000ull /**< Interval between publishes. */
+
+/**
+ * @brief Adds to a process-wide counter. Safe to call from any thread.
+ * @param stat Counter to add to.
+ * @param count Amount to add.
+ */
+void glps_stats_add(GLPS_STAT stat, uint64_t count);
+
+/**
+ * @brief Creates and maps the stats page.
+ * @param publisher Publisher of the window manager, not publishing.
+ * @return false if shared memory is unavailable.
+ */
+bool glps_stats_page_open(glps_StatsPublisher *publisher);
+
+/**
+ * @brief Unmaps and closes the stats page.
+ * @param publisher Publisher of the window manager.
+ */
+void glps_stats_page_close(glps_StatsPublisher *publisher);
+
+/**
+ * @brief Rewrites the stats page if the publish interval has passed.
+ * @param wm Window manager whose counters are published.
+ */
+void glps_stats_publish(glps_WindowManager *wm);
+
+#endif
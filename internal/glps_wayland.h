@@ -140,10 +140,33 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
 
 void glps_wl_window_is_resizable(glps_WindowManager *wm, bool state, size_t window_id);
 
+void glps_wl_window_set_render_scale(glps_WindowManager *wm, size_t window_id,
+                                     double scale);
+
+void glps_wl_window_request_redraw(glps_WindowManager *wm, size_t window_id);
+
+void glps_wl_window_set_event_mask(glps_WindowManager *wm, size_t window_id,
+                                   unsigned int mask);
+
+size_t glps_wl_get_outputs(glps_WindowManager *wm, glps_Output *outputs,
+                           size_t max_outputs);
+bool glps_wl_window_get_output(glps_WindowManager *wm, size_t window_id,
+                               glps_Output *output);
+
 bool glps_wl_should_close(glps_WindowManager *wm);
 
 void glps_wl_window_destroy(glps_WindowManager *wm, size_t window_id);
+size_t glps_wl_window_pool_reserve(glps_WindowManager *wm, size_t count);
+ssize_t glps_wl_popup_create(glps_WindowManager *wm, size_t parent_id, int x,
+                             int y, int width, int height, bool grab);
+ssize_t glps_wl_subsurface_create(glps_WindowManager *wm, size_t parent_id,
+                                  int x, int y, int width, int height);
+void glps_wl_subsurface_set_position(glps_WindowManager *wm, size_t window_id,
+                                     int x, int y);
 void glps_wl_cursor_change(glps_WindowManager* wm, GLPS_CURSOR_TYPE user_cursor);
+bool glps_wl_set_event_thread(glps_WindowManager *wm, bool enabled);
+void glps_wl_latch_input(glps_WindowManager *wm);
+void glps_wl_window_run_frame(glps_WindowManager *wm, size_t window_id);
 
 void glps_wl_destroy();
 
@@ -171,6 +194,14 @@ extern struct wl_registry_listener registry_listener;
 
 extern struct wl_callback_listener frame_callback_listener;
 
+extern struct wp_fractional_scale_v1_listener fractional_scale_listener;
+
+extern struct wl_output_listener wl_output_listener;
+
+extern struct zxdg_output_v1_listener xdg_output_listener;
+
+extern struct wl_surface_listener wl_surface_listener;
+
 #endif
 
 #endif
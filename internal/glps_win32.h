@@ -22,6 +22,13 @@ void glps_win32_get_from_clipboard(glps_WindowManager *wm, char *data,
 
 bool glps_win32_should_close(glps_WindowManager* wm);
 
+void glps_win32_latch_input(glps_WindowManager *wm, size_t window_id);
+
 void glps_win32_cursor_change(glps_WindowManager*wm, GLPS_CURSOR_TYPE cursor_type);
 
+size_t glps_win32_get_outputs(glps_WindowManager *wm, glps_Output *outputs,
+                              size_t max_outputs);
+bool glps_win32_window_get_output(glps_WindowManager *wm, size_t window_id,
+                                  glps_Output *output);
+
 #endif
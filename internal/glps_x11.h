@@ -3,11 +3,29 @@
 
 #include "glps_common.h"
 
+/* Progress of a _NET_WM_SYNC_REQUEST through configure and redraw. */
+enum
+{
+    GLPS_X11_SYNC_IDLE,       /**< No request pending. */
+    GLPS_X11_SYNC_REQUESTED,  /**< Request received, awaiting its ConfigureNotify. */
+    GLPS_X11_SYNC_CONFIGURED, /**< Configured, counter is set after the next swap. */
+};
+
 void glps_x11_init(glps_WindowManager *wm);
 
 ssize_t glps_x11_window_create(glps_WindowManager *wm, const char *title,
                                int width, int height);
+ssize_t glps_x11_popup_create(glps_WindowManager *wm, size_t parent_id,
+                              int x, int y, int width, int height, bool grab);
+ssize_t glps_x11_subsurface_create(glps_WindowManager *wm, size_t parent_id,
+                                   int x, int y, int width, int height);
+void glps_x11_subsurface_set_position(glps_WindowManager *wm, size_t window_id,
+                                      int x, int y);
+void glps_x11_window_destroy(glps_WindowManager *wm, size_t window_id);
 
+bool glps_x11_set_event_thread(glps_WindowManager *wm, bool enabled);
+void glps_x11_latch_input(glps_WindowManager *wm, size_t window_id);
+void glps_x11_window_run_frame(glps_WindowManager *wm, size_t window_id);
 void glps_x11_destroy(glps_WindowManager *wm);
 void glps_x11_get_window_dimensions(glps_WindowManager *wm, size_t window_id,
                                     int *width, int *height);
@@ -23,4 +41,23 @@ void glps_x11_window_update(glps_WindowManager *wm, size_t window_id);
 void glps_x11_window_is_resizable(glps_WindowManager *wm, bool state, size_t window_id);
 void glps_x11_toggle_window_decorations(glps_WindowManager *wm, bool state, size_t window_id);
 void glps_x11_cursor_change(glps_WindowManager *wm, GLPS_CURSOR_TYPE user_cursor);
+ssize_t glps_x11_cursor_create_image(glps_WindowManager *wm,
+                                     const unsigned char *rgba, int width,
+                                     int height, int hot_x, int hot_y);
+void glps_x11_cursor_set_image(glps_WindowManager *wm, size_t cursor_id);
+
+/**
+ * @brief Tells the window manager a frame at the configured size was swapped.
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the swapped window.
+ */
+void glps_x11_window_swapped(glps_WindowManager *wm, size_t window_id);
+
+void glps_x11_window_set_event_mask(glps_WindowManager *wm, size_t window_id,
+                                   unsigned int mask);
+
+size_t glps_x11_get_outputs(glps_WindowManager *wm, glps_Output *outputs,
+                            size_t max_outputs);
+bool glps_x11_window_get_output(glps_WindowManager *wm, size_t window_id,
+                                glps_Output *output);
 #endif
\ No newline at end of file
@@ -167,6 +167,16 @@ void set_logging_enabled(bool enabled);
  */
 void set_minimum_log_level(DebugLevel level);
 
+/**
+ * @brief Returns how many messages were not logged.
+ *
+ * Counts messages filtered out because logging was disabled or their level
+ * was below the minimum level.
+ *
+ * @return Number of dropped messages since the process started.
+ */
+size_t get_dropped_log_count(void);
+
 /**
  * @brief Prints the current stack trace.
  *
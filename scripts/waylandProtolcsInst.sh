@@ -2,7 +2,8 @@
 
 WAYLAND_PROTOCOLS_GIT="https://gitlab.freedesktop.org/wayland/wayland-protocols.git"
 WLR_PROTOCOLS_GIT="https://gitlab.freedesktop.org/wlroots/wlr-protocols.git"
-OUTPUTS=(xdg-shell xdg-dialog xdg-decorations xdg-toplevel-tag wlr-data-control-unstable-v1)
+OUTPUTS=(xdg-shell xdg-dialog xdg-decorations xdg-toplevel-tag viewporter fractional-scale-v1 xdg-output)
+WLR_DATA_CTL_OUTPUT=wlr-data-control-unstable-v1
 
 SCRIPT_PATH=$0 
 SCRIPT_PATH="$(realpath "$(dirname "${SCRIPT_PATH}")")"
@@ -20,11 +21,28 @@ WAYLAND_PROTOCOLS=(
     "unstable/xdg-dialog/xdg-dialog-unstable-v1.xml"
     "unstable/xdg-decoration/xdg-decoration-unstable-v1.xml"
     "staging/xdg-toplevel-tag/xdg-toplevel-tag-v1.xml"
+    "stable/viewporter/viewporter.xml"
+    "staging/fractional-scale/fractional-scale-v1.xml"
+    "unstable/xdg-output/xdg-output-unstable-v1.xml"
 )
 
 
-if [[ -n "$(ls -A "${OUTPUT_HEADER_DIR}" 2>/dev/null)" ]]; then 
-    echo "${OUTPUT_HEADER_DIR} is not empty, Nothing to do"
+# Only generate protocols that are missing, so existing checkouts pick up
+# newly added ones.
+MISSING_WAYLAND=()
+for i in "${!WAYLAND_PROTOCOLS[@]}"; do
+    if [[ ! -f "${OUTPUT_HEADER_DIR}/${OUTPUTS[$i]}.h" ]]; then
+        MISSING_WAYLAND+=("$i")
+    fi
+done
+
+MISSING_WLR=0
+if [[ ! -f "${OUTPUT_HEADER_DIR}/${WLR_DATA_CTL_OUTPUT}.h" ]]; then
+    MISSING_WLR=1
+fi
+
+if [[ ${#MISSING_WAYLAND[@]} -eq 0 && ${MISSING_WLR} -eq 0 ]]; then 
+    echo "All protocol files already exist, Nothing to do"
     echo "Exiting ..."
     exit 0 
 fi
@@ -34,6 +52,7 @@ mkdir -p "${OUTPUT_SRC_DIR}"
 mkdir -p "${OUTPUT_HEADER_DIR}"
 
 
+if [[ ${#MISSING_WAYLAND[@]} -gt 0 ]]; then
 echo "Cloning the Wayland Protocols repository..."
 if [[ ! -d "$WAYLAND_PROTOCOLS_DIR" ]]; then
     git clone --depth 1 "$WAYLAND_PROTOCOLS_GIT" "${WAYLAND_PROTOCOLS_DIR}/" || {
@@ -45,7 +64,7 @@ else
 fi
 
 
-for i in "${!WAYLAND_PROTOCOLS[@]}"; do 
+for i in "${MISSING_WAYLAND[@]}"; do 
     protocol_path="${WAYLAND_PROTOCOLS_DIR}/${WAYLAND_PROTOCOLS[$i]}"
     
     if [[ ! -f "$protocol_path" ]]; then
@@ -71,8 +90,10 @@ for i in "${!WAYLAND_PROTOCOLS[@]}"; do
         continue
     fi
 done
+fi
 
 
+if [[ ${MISSING_WLR} -eq 1 ]]; then
 echo "Cloning wlr-protocols repository..."
 if [[ ! -d "$WLR_PROTOCOLS_DIR" ]]; then
     git clone --depth 1 "$WLR_PROTOCOLS_GIT" "${WLR_PROTOCOLS_DIR}/" || {
@@ -94,8 +115,8 @@ fi
 echo "Found wlr-data-control protocol at: $WLR_DATA_CTL_XML"
 
 
-header_out="${OUTPUT_HEADER_DIR}/${OUTPUTS[4]}.h"
-src_out="${OUTPUT_SRC_DIR}/${OUTPUTS[4]}.c"
+header_out="${OUTPUT_HEADER_DIR}/${WLR_DATA_CTL_OUTPUT}.h"
+src_out="${OUTPUT_SRC_DIR}/${WLR_DATA_CTL_OUTPUT}.c"
 
 echo "Generating wlr-data-control header: $header_out"
 if ! wayland-scanner client-header "$WLR_DATA_CTL_XML" "$header_out"; then
@@ -108,6 +129,7 @@ if ! wayland-scanner private-code "$WLR_DATA_CTL_XML" "$src_out"; then
     echo "Error generating wlr-data-control source"
     exit 1
 fi
+fi
 
 
 echo "Cleaning up temporary directories..."
@@ -23,7 +23,9 @@
 
 #include "glps_audio_stream.h"
 #include "glps_common.h"
+#include "glps_stats.h"
 #include "glps_thread.h"
+#include "glps_trace.h"
 #include "utils/logger/pico_logger.h"
 #include <alsa/asoundlib.h>
 #include <stdio.h>
@@ -177,9 +179,15 @@ void *__audio_thread_func(void *arg)
             am->pcm_buffer[i] *= am->volume;
         }
 
+        uint64_t trace_start = GLPS_TRACE_BEGIN();
         snd_pcm_sframes_t frames = snd_pcm_writei(handle, am->pcm_buffer, framesRead);
+        GLPS_TRACE_END("snd_pcm_writei", trace_start);
         if (frames < 0)
         {
+            if (frames == -EPIPE)
+            {
+                glps_stats_add(GLPS_STAT_AUDIO_XRUNS, 1);
+            }
             frames = snd_pcm_recover(handle, frames, 0);
         }
         if (frames < 0)
@@ -0,0 +1,116 @@
+#include "glps_dynamic_resolution.h"
+
+/* Scales are applied per axis, so each step cuts pixel count by ~20%. */
+static const double scale_steps[] = {1.0, 0.9, 0.8, 0.7, 0.6, 0.5};
+
+#define GLPS_DYNRES_STEP_COUNT (sizeof(scale_steps) / sizeof(scale_steps[0]))
+#define GLPS_DYNRES_SMOOTHING 0.1 /**< Weight of a new sample in the average. */
+#define GLPS_DYNRES_HEADROOM 0.75 /**< Cost below target * headroom may step up. */
+#define GLPS_DYNRES_DOWN_FRAMES 8  /**< Frames over target before stepping down. */
+#define GLPS_DYNRES_UP_FRAMES 90   /**< Frames with headroom before stepping up. */
+
+void glps_dynamic_resolution_start(glps_DynamicResolution *dr,
+                                   uint64_t target_ns)
+{
+  *dr = (glps_DynamicResolution){0};
+  dr->enabled = true;
+  dr->target_ns = target_ns;
+}
+
+double glps_dynamic_resolution_scale(const glps_DynamicResolution *dr)
+{
+  return scale_steps[dr->step];
+}
+
+static int __scale_extent(int extent, double scale)
+{
+  if (extent <= 0)
+    return 0;
+
+  int scaled = (int)(extent * scale + 0.5);
+  return scaled > 0 ? scaled : 1;
+}
+
+void glps_dynamic_resolution_buffer_size(int width, int height, double scale,
+                                         int *buffer_width, int *buffer_height)
+{
+  *buffer_width = __scale_extent(width, scale);
+  *buffer_height = __scale_extent(height, scale);
+}
+
+/* Returns the newest unread sample of a ring, or 0 if there is none. */
+static uint64_t __take_sample(const uint64_t *samples, atomic_uint_fast64_t *head,
+                              uint64_t *consumed)
+{
+  uint64_t current = atomic_load_explicit(head, memory_order_acquire);
+  if (current == *consumed)
+    return 0;
+
+  *consumed = current;
+  return samples[(current - 1) % GLPS_FRAME_STATS_CAPACITY];
+}
+
+static bool __step(glps_DynamicResolution *dr, size_t step, double *scale)
+{
+  // Buffers are the window size times the scale, so a lower step only gives
+  // fewer pixels while the table keeps falling.
+  assert(step == 0 || scale_steps[step] < scale_steps[step - 1]);
+
+  dr->step = step;
+  dr->over_count = 0;
+  dr->under_count = 0;
+  // The old cost no longer reflects the new resolution.
+  dr->filtered_ns = 0.0;
+  *scale = scale_steps[step];
+  return true;
+}
+
+bool glps_dynamic_resolution_update(glps_DynamicResolution *dr,
+                                    glps_FrameStatsRing *ring, double *scale)
+{
+  if (!dr->enabled || dr->target_ns == 0)
+    return false;
+
+  // Both rings are consumed so a stalled GPU timer falls back to the frame
+  // interval instead of freezing the controller.
+  uint64_t frame_sample =
+      __take_sample(ring->frame_ns, &ring->head, &dr->frame_head);
+  uint64_t sample = __take_sample(ring->gpu_ns, &ring->gpu_head, &dr->gpu_head);
+  if (sample == 0)
+    sample = frame_sample;
+  if (sample == 0)
+    return false;
+
+  if (dr->filtered_ns == 0.0)
+    dr->filtered_ns = (double)sample;
+  else
+    dr->filtered_ns += GLPS_DYNRES_SMOOTHING * ((double)sample - dr->filtered_ns);
+
+  double target = (double)dr->target_ns;
+
+  if (dr->filtered_ns > target)
+  {
+    dr->under_count = 0;
+    if (++dr->over_count >= GLPS_DYNRES_DOWN_FRAMES &&
+        dr->step + 1 < GLPS_DYNRES_STEP_COUNT)
+    {
+      return __step(dr, dr->step + 1, scale);
+    }
+  }
+  else if (dr->filtered_ns < target * GLPS_DYNRES_HEADROOM)
+  {
+    dr->over_count = 0;
+    if (++dr->under_count >= GLPS_DYNRES_UP_FRAMES && dr->step > 0)
+    {
+      return __step(dr, dr->step - 1, scale);
+    }
+  }
+  else
+  {
+    // Between the thresholds: hold the current step.
+    dr->over_count = 0;
+    dr->under_count = 0;
+  }
+
+  return false;
+}
@@ -1,5 +1,6 @@
 
 #include <glps_egl_context.h>
+#include "glps_trace.h"
 #include "utils/logger/pico_logger.h"
 
 void glps_egl_init(glps_WindowManager *wm, EGLNativeDisplayType display) {
@@ -70,8 +71,12 @@ void glps_egl_create_ctx(glps_WindowManager *wm) {
 }
 
 void glps_egl_make_ctx_current(glps_WindowManager *wm, size_t window_id) {
-  if (!eglMakeCurrent(wm->egl_ctx->dpy, wm->windows[window_id]->egl_surface,
-                      wm->windows[window_id]->egl_surface, wm->egl_ctx->ctx)) {
+  uint64_t trace_start = GLPS_TRACE_BEGIN();
+  EGLBoolean made_current =
+      eglMakeCurrent(wm->egl_ctx->dpy, wm->windows[window_id]->egl_surface,
+                     wm->windows[window_id]->egl_surface, wm->egl_ctx->ctx);
+  GLPS_TRACE_END("eglMakeCurrent", trace_start);
+  if (!made_current) {
     EGLint error = eglGetError();
     LOG_ERROR("eglMakeCurrent failed: 0x%x", error);
     if (error == EGL_BAD_DISPLAY)
@@ -86,7 +91,9 @@ void glps_egl_make_ctx_current(glps_WindowManager *wm, size_t window_id) {
   }
 }
 
-void *glps_egl_get_proc_addr(const char* name) { return eglGetProcAddress; }
+void *glps_egl_get_proc_addr(const char *name) {
+  return (void *)eglGetProcAddress(name);
+}
 
 void glps_egl_destroy(glps_WindowManager *wm) {
 
@@ -103,6 +110,8 @@ void glps_egl_destroy(glps_WindowManager *wm) {
 }
 
 void glps_egl_swap_buffers(glps_WindowManager *wm, size_t window_id) {
+  uint64_t trace_start = GLPS_TRACE_BEGIN();
   eglSwapBuffers(wm->egl_ctx->dpy, wm->windows[window_id]->egl_surface);
+  GLPS_TRACE_END("eglSwapBuffers", trace_start);
 }
 
@@ -0,0 +1,429 @@
+#include "glps_event_loop.h"
+#include "utils/logger/pico_logger.h"
+
+#ifndef GLPS_USE_WIN32
+#include <poll.h>
+#endif
+#if defined(__linux__) && !defined(GLPS_USE_WIN32)
+#include <sys/eventfd.h>
+#endif
+
+/* Links a task in as the newest one. Producers only ever touch the head, so
+ * pushing is a swap and a store. */
+static void __push(glps_EventLoop *loop, glps_Task *task)
+{
+  atomic_store_explicit(&task->next, NULL, memory_order_relaxed);
+  glps_Task *prev = atomic_exchange_explicit(&loop->head, task,
+                                             memory_order_acq_rel);
+  atomic_store_explicit(&prev->next, task, memory_order_release);
+}
+
+/* Unlinks the oldest task. Returns NULL when the queue is empty or a
+ * producer is between its swap and its store; the producer's wakeup follows
+ * the store, so such a task is picked up by the next run. */
+static glps_Task *__pop(glps_EventLoop *loop)
+{
+  glps_Task *tail = loop->tail;
+  glps_Task *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+  if (tail == &loop->stub)
+  {
+    if (next == NULL)
+      return NULL;
+    loop->tail = next;
+    tail = next;
+    next = atomic_load_explicit(&next->next, memory_order_acquire);
+  }
+
+  if (next != NULL)
+  {
+    loop->tail = next;
+    return tail;
+  }
+
+  if (tail != atomic_load_explicit(&loop->head, memory_order_acquire))
+    return NULL;
+
+  // Re-insert the stub so the last task can be unlinked.
+  __push(loop, &loop->stub);
+  next = atomic_load_explicit(&tail->next, memory_order_acquire);
+  if (next != NULL)
+  {
+    loop->tail = next;
+    return tail;
+  }
+
+  return NULL;
+}
+
+static void __signal(glps_EventLoop *loop)
+{
+  // One wakeup covers every task posted until the event thread runs.
+  if (atomic_exchange_explicit(&loop->wake_pending, true, memory_order_acq_rel))
+    return;
+
+#ifdef GLPS_USE_WIN32
+  if (loop->wake_event != NULL)
+    SetEvent(loop->wake_event);
+#else
+  if (loop->wake_write_fd >= 0)
+  {
+    uint64_t one = 1;
+    ssize_t written;
+    do
+    {
+      written = write(loop->wake_write_fd, &one,
+                      loop->wake_write_fd == loop->wake_fd ? sizeof(one) : 1);
+    } while (written < 0 && errno == EINTR);
+  }
+#endif
+}
+
+static void __drain(glps_EventLoop *loop)
+{
+#ifdef GLPS_USE_WIN32
+  // The event resets itself when a wait returns on it.
+  (void)loop;
+#else
+  if (loop->wake_fd < 0)
+    return;
+
+  uint64_t buffer[8];
+  while (read(loop->wake_fd, buffer, sizeof(buffer)) > 0)
+  {
+    // A pipe may hold several bytes; an eventfd is reset by one read.
+    if (loop->wake_fd == loop->wake_write_fd)
+      break;
+  }
+#endif
+}
+
+#ifndef GLPS_USE_WIN32
+static short __poll_events(unsigned int events)
+{
+  short poll_events = 0;
+  if (events & GLPS_FD_READABLE)
+    poll_events |= POLLIN;
+  if (events & GLPS_FD_WRITABLE)
+    poll_events |= POLLOUT;
+  return poll_events;
+}
+
+static unsigned int __fd_events(short revents)
+{
+  unsigned int events = 0;
+  if (revents & POLLIN)
+    events |= GLPS_FD_READABLE;
+  if (revents & POLLOUT)
+    events |= GLPS_FD_WRITABLE;
+  if (revents & (POLLERR | POLLHUP | POLLNVAL))
+    events |= GLPS_FD_ERROR;
+  return events;
+}
+
+/* Calls back the watches the last poll found ready. Callbacks may add and
+ * remove watches; removed ones are skipped, added ones wait for a poll. */
+static void __dispatch_watches(glps_EventLoop *loop)
+{
+  for (size_t i = 0; i < loop->watch_count; ++i)
+  {
+    glps_FdWatch *watch = &loop->watches[i];
+    unsigned int ready = watch->ready;
+    if (watch->fd < 0 || ready == 0)
+      continue;
+
+    watch->ready = 0;
+    watch->callback(watch->fd, ready, watch->data);
+  }
+}
+
+bool glps_event_loop_add_fd(glps_EventLoop *loop, int fd, unsigned int events,
+                            void (*callback)(int fd, unsigned int events,
+                                             void *data),
+                            void *data)
+{
+  glps_FdWatch *slot = NULL;
+
+  for (size_t i = 0; i < loop->watch_count; ++i)
+  {
+    if (loop->watches[i].fd == fd)
+    {
+      slot = &loop->watches[i];
+      break;
+    }
+    if (slot == NULL && loop->watches[i].fd < 0)
+      slot = &loop->watches[i];
+  }
+
+  if (slot == NULL)
+  {
+    if (loop->watch_count >= GLPS_MAX_FD_WATCHES)
+    {
+      LOG_ERROR("Couldn't watch fd %d. All %d slots are taken.", fd,
+                GLPS_MAX_FD_WATCHES);
+      return false;
+    }
+    slot = &loop->watches[loop->watch_count++];
+  }
+
+  *slot = (glps_FdWatch){.fd = fd,
+                         .events = events,
+                         .callback = callback,
+                         .data = data};
+  return true;
+}
+
+void glps_event_loop_remove_fd(glps_EventLoop *loop, int fd)
+{
+  for (size_t i = 0; i < loop->watch_count; ++i)
+  {
+    if (loop->watches[i].fd == fd)
+    {
+      loop->watches[i] = (glps_FdWatch){.fd = -1};
+      break;
+    }
+  }
+
+  while (loop->watch_count > 0 && loop->watches[loop->watch_count - 1].fd < 0)
+    --loop->watch_count;
+}
+
+int glps_event_loop_poll(glps_EventLoop *loop, int display_fd, int timeout_ms)
+{
+  struct pollfd pfds[2 + GLPS_MAX_FD_WATCHES];
+  size_t watch_index[GLPS_MAX_FD_WATCHES];
+  nfds_t count = 0;
+
+  // A negative descriptor is ignored by poll().
+  pfds[count++] = (struct pollfd){.fd = display_fd, .events = POLLIN};
+  pfds[count++] = (struct pollfd){.fd = loop->wake_fd, .events = POLLIN};
+
+  size_t watch_total = 0;
+  for (size_t i = 0; i < loop->watch_count; ++i)
+  {
+    if (loop->watches[i].fd < 0)
+      continue;
+    watch_index[watch_total++] = i;
+    pfds[count++] = (struct pollfd){
+        .fd = loop->watches[i].fd,
+        .events = __poll_events(loop->watches[i].events)};
+  }
+
+  if (poll(pfds, count, timeout_ms) < 0)
+    return -1;
+
+  for (size_t i = 0; i < watch_total; ++i)
+  {
+    loop->watches[watch_index[i]].ready |= __fd_events(pfds[2 + i].revents);
+  }
+  loop->polled = true;
+
+  return pfds[0].revents;
+}
+
+void glps_event_loop_wake(glps_EventLoop *loop)
+{
+  __signal(loop);
+}
+
+bool glps_event_reader_start(glps_EventReader *reader, void *(*body)(void *),
+                             void *arg)
+{
+  if (pipe(reader->wake_fds) != 0)
+  {
+    LOG_ERROR("Failed to create event reader pipe: %s", strerror(errno));
+    return false;
+  }
+  for (int i = 0; i < 2; ++i)
+  {
+    fcntl(reader->wake_fds[i], F_SETFL,
+          fcntl(reader->wake_fds[i], F_GETFL) | O_NONBLOCK);
+    fcntl(reader->wake_fds[i], F_SETFD, FD_CLOEXEC);
+  }
+
+  atomic_store(&reader->stop, false);
+  atomic_store(&reader->failed, false);
+
+  if (glps_thread_create(&reader->thread, NULL, body, arg) != 0)
+  {
+    LOG_ERROR("Failed to start event reader thread.");
+    close(reader->wake_fds[0]);
+    close(reader->wake_fds[1]);
+    return false;
+  }
+
+  reader->running = true;
+  return true;
+}
+
+void glps_event_reader_stop(glps_EventReader *reader)
+{
+  if (!reader->running)
+    return;
+
+  atomic_store(&reader->stop, true);
+  glps_event_reader_wake(reader);
+  glps_thread_join(reader->thread, NULL);
+
+  close(reader->wake_fds[0]);
+  close(reader->wake_fds[1]);
+  reader->running = false;
+}
+
+void glps_event_reader_wake(glps_EventReader *reader)
+{
+  char byte = 0;
+  ssize_t written;
+  do
+  {
+    written = write(reader->wake_fds[1], &byte, 1);
+  } while (written < 0 && errno == EINTR);
+}
+
+bool glps_event_reader_wait(glps_EventReader *reader, int display_fd)
+{
+  struct pollfd pfds[2] = {
+      {.fd = display_fd, .events = POLLIN},
+      {.fd = reader->wake_fds[0], .events = POLLIN},
+  };
+
+  if (poll(pfds, 2, -1) < 0)
+    return false;
+
+  if (pfds[1].revents & POLLIN)
+  {
+    char buffer[64];
+    while (read(reader->wake_fds[0], buffer, sizeof(buffer)) > 0)
+      ;
+  }
+
+  return (pfds[0].revents & (POLLIN | POLLERR | POLLHUP)) != 0;
+}
+
+bool glps_event_reader_should_stop(glps_EventReader *reader)
+{
+  return atomic_load(&reader->stop);
+}
+#endif
+
+bool glps_event_loop_init(glps_EventLoop *loop)
+{
+  atomic_init(&loop->stub.next, NULL);
+  atomic_init(&loop->head, &loop->stub);
+  atomic_init(&loop->wake_pending, false);
+  atomic_init(&loop->pending, 0);
+  loop->tail = &loop->stub;
+
+#ifdef GLPS_USE_WIN32
+  loop->wake_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+  if (loop->wake_event == NULL)
+  {
+    LOG_ERROR("Failed to create task queue wakeup event.");
+    return false;
+  }
+#elif defined(__linux__)
+  loop->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  loop->wake_write_fd = loop->wake_fd;
+  if (loop->wake_fd < 0)
+  {
+    LOG_ERROR("Failed to create task queue eventfd: %s", strerror(errno));
+    return false;
+  }
+#else
+  int fds[2];
+  loop->wake_fd = -1;
+  loop->wake_write_fd = -1;
+  if (pipe(fds) != 0)
+  {
+    LOG_ERROR("Failed to create task queue pipe: %s", strerror(errno));
+    return false;
+  }
+  for (int i = 0; i < 2; ++i)
+  {
+    fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+  }
+  loop->wake_fd = fds[0];
+  loop->wake_write_fd = fds[1];
+#endif
+
+  return true;
+}
+
+void glps_event_loop_destroy(glps_EventLoop *loop)
+{
+  glps_Task *task;
+  while ((task = __pop(loop)) != NULL)
+  {
+    free(task);
+  }
+
+#ifdef GLPS_USE_WIN32
+  if (loop->wake_event != NULL)
+  {
+    CloseHandle(loop->wake_event);
+    loop->wake_event = NULL;
+  }
+#else
+  if (loop->wake_write_fd >= 0 && loop->wake_write_fd != loop->wake_fd)
+    close(loop->wake_write_fd);
+  if (loop->wake_fd >= 0)
+    close(loop->wake_fd);
+  loop->wake_fd = -1;
+  loop->wake_write_fd = -1;
+#endif
+}
+
+bool glps_event_loop_post(glps_EventLoop *loop, void (*fn)(void *), void *arg)
+{
+  glps_Task *task = malloc(sizeof(glps_Task));
+  if (task == NULL)
+  {
+    LOG_ERROR("Failed to allocate posted task.");
+    return false;
+  }
+
+  task->fn = fn;
+  task->arg = arg;
+  atomic_fetch_add_explicit(&loop->pending, 1, memory_order_relaxed);
+  __push(loop, task);
+  __signal(loop);
+  return true;
+}
+
+size_t glps_event_loop_run(glps_EventLoop *loop)
+{
+#ifndef GLPS_USE_WIN32
+  if (!loop->polled && loop->watch_count > 0)
+    glps_event_loop_poll(loop, -1, 0);
+  loop->polled = false;
+  __dispatch_watches(loop);
+#endif
+
+  // Cleared before popping: a task posted from here on signals again.
+  if (atomic_exchange_explicit(&loop->wake_pending, false, memory_order_acq_rel))
+    __drain(loop);
+
+  size_t count = 0;
+  glps_Task *task;
+  while (count < GLPS_EVENT_LOOP_BATCH && (task = __pop(loop)) != NULL)
+  {
+    atomic_fetch_sub_explicit(&loop->pending, 1, memory_order_relaxed);
+    task->fn(task->arg);
+    free(task);
+    ++count;
+  }
+
+  // Leave the rest for the next dispatch, which then doesn't sleep.
+  if (count == GLPS_EVENT_LOOP_BATCH)
+    __signal(loop);
+
+  return count;
+}
+
+#ifdef GLPS_USE_WIN32
+HANDLE glps_event_loop_handle(const glps_EventLoop *loop)
+{
+  return loop->wake_event;
+}
+#endif
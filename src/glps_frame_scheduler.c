@@ -0,0 +1,198 @@
+#include "glps_frame_scheduler.h"
+#include "glps_frame_stats.h"
+#include "glps_window_manager.h"
+
+#ifdef GLPS_USE_WAYLAND
+#include "glps_wayland.h"
+#endif
+
+#ifdef GLPS_USE_X11
+#include "glps_x11.h"
+#endif
+
+#define GLPS_SCHEDULER_MAX_DEFERRED 3 /**< Periods a background frame may be put off. */
+#define GLPS_SCHEDULER_SMOOTHING 8    /**< A new cost weighs 1/8 in the average. */
+
+/* Deadlines stretch by these factors, so a focused window wins against a
+ * hovered one and both win against the rest. */
+#define GLPS_SCHEDULER_WEIGHT_FOCUSED 1
+#define GLPS_SCHEDULER_WEIGHT_HOVERED 2
+#define GLPS_SCHEDULER_WEIGHT_BACKGROUND 4
+
+static uint64_t __window_period_ns(glps_WindowManager *wm, size_t window_id)
+{
+  glps_Output output;
+  if (glps_wm_window_get_output(wm, window_id, &output) &&
+      output.refresh_hz > 0.0)
+  {
+    return (uint64_t)(1e9 / output.refresh_hz);
+  }
+
+  uint64_t budget_ns = atomic_load_explicit(
+      &wm->windows[window_id]->frame_stats.budget_ns, memory_order_relaxed);
+  return budget_ns != 0 ? budget_ns : GLPS_DEFAULT_FRAME_BUDGET_NS;
+}
+
+static bool __is_focused(glps_WindowManager *wm, size_t window_id)
+{
+  return wm->windows[window_id]->input.keyboard_focus;
+}
+
+static uint64_t __weight(glps_WindowManager *wm, size_t window_id)
+{
+  if (__is_focused(wm, window_id))
+    return GLPS_SCHEDULER_WEIGHT_FOCUSED;
+  if (wm->windows[window_id]->input.pointer_inside)
+    return GLPS_SCHEDULER_WEIGHT_HOVERED;
+  return GLPS_SCHEDULER_WEIGHT_BACKGROUND;
+}
+
+void glps_frame_scheduler_ready(glps_WindowManager *wm, size_t window_id)
+{
+  glps_FrameSchedule *schedule = &wm->windows[window_id]->schedule;
+
+  // A frame that is already waiting keeps its place.
+  if (schedule->pending)
+    return;
+
+  schedule->pending = true;
+  schedule->period_ns = __window_period_ns(wm, window_id);
+  schedule->deadline_ns = glps_frame_stats_now_ns() +
+                          schedule->period_ns * __weight(wm, window_id);
+}
+
+static void __run_frame(glps_WindowManager *wm, size_t window_id)
+{
+#ifdef GLPS_USE_WAYLAND
+  glps_wl_window_run_frame(wm, window_id);
+#endif
+
+#ifdef GLPS_USE_X11
+  glps_x11_window_run_frame(wm, window_id);
+#endif
+
+#ifdef GLPS_USE_WIN32
+  // Win32 draws from WM_PAINT and never marks frames ready.
+  (void)wm;
+  (void)window_id;
+#endif
+}
+
+/* Starts a new budget period once the current one is over. The period is the
+ * shortest refresh period among the windows, so no output misses a vsync. */
+static void __begin_period(glps_WindowManager *wm, uint64_t now)
+{
+  glps_FrameScheduler *scheduler = &wm->scheduler;
+
+  if (scheduler->period_ns != 0 &&
+      now - scheduler->period_start_ns < scheduler->period_ns)
+    return;
+
+  scheduler->period_start_ns = now;
+  scheduler->spent_ns = 0;
+  scheduler->period_ns = 0;
+
+  for (size_t i = 0; i < wm->window_count; ++i)
+  {
+    if (wm->windows[i] == NULL || !wm->windows[i]->schedule.pending)
+      continue;
+    uint64_t period_ns = wm->windows[i]->schedule.period_ns;
+    if (scheduler->period_ns == 0 || period_ns < scheduler->period_ns)
+      scheduler->period_ns = period_ns;
+  }
+}
+
+/* Finds the ready window with the earliest deadline this pass hasn't put off
+ * yet. Searching again after every frame copes with callbacks that create or
+ * destroy windows. */
+static ssize_t __next_window(glps_WindowManager *wm)
+{
+  ssize_t next = -1;
+
+  for (size_t i = 0; i < wm->window_count; ++i)
+  {
+    if (wm->windows[i] == NULL)
+      continue;
+
+    glps_FrameSchedule *schedule = &wm->windows[i]->schedule;
+    if (!schedule->pending || schedule->pass == wm->scheduler.pass)
+      continue;
+
+    if (next < 0 ||
+        schedule->deadline_ns < wm->windows[next]->schedule.deadline_ns)
+      next = (ssize_t)i;
+  }
+
+  return next;
+}
+
+size_t glps_frame_scheduler_run(glps_WindowManager *wm)
+{
+  glps_FrameScheduler *scheduler = &wm->scheduler;
+  size_t count = 0;
+  ssize_t window_id;
+
+  ++scheduler->pass;
+  __begin_period(wm, glps_frame_stats_now_ns());
+
+  while ((window_id = __next_window(wm)) >= 0)
+  {
+    glps_FrameSchedule *schedule = &wm->windows[window_id]->schedule;
+
+    // Background frames give way once the period's budget is spent, but only
+    // for a few periods, so they slow down instead of stopping.
+    if (!__is_focused(wm, (size_t)window_id) &&
+        scheduler->spent_ns + schedule->cost_ns > scheduler->period_ns &&
+        schedule->deferred < GLPS_SCHEDULER_MAX_DEFERRED)
+    {
+      schedule->pass = scheduler->pass;
+      // A period spans several passes; each counts once.
+      if (schedule->deferred_period_ns != scheduler->period_start_ns)
+      {
+        schedule->deferred_period_ns = scheduler->period_start_ns;
+        ++schedule->deferred;
+      }
+      continue;
+    }
+
+    schedule->pending = false;
+    schedule->deferred = 0;
+
+    uint64_t start = glps_frame_stats_now_ns();
+    void *window = wm->windows[window_id];
+    __run_frame(wm, (size_t)window_id);
+    uint64_t elapsed = glps_frame_stats_now_ns() - start;
+
+    scheduler->spent_ns += elapsed;
+    ++count;
+
+    // The callback may have destroyed the window.
+    if ((size_t)window_id < wm->window_count &&
+        (void *)wm->windows[window_id] == window)
+    {
+      schedule->cost_ns = schedule->cost_ns == 0
+                              ? elapsed
+                              : schedule->cost_ns -
+                                    schedule->cost_ns / GLPS_SCHEDULER_SMOOTHING +
+                                    elapsed / GLPS_SCHEDULER_SMOOTHING;
+    }
+  }
+
+  return count;
+}
+
+int glps_frame_scheduler_timeout_ms(glps_WindowManager *wm)
+{
+  bool waiting = false;
+  for (size_t i = 0; i < wm->window_count && !waiting; ++i)
+  {
+    waiting = wm->windows[i] != NULL && wm->windows[i]->schedule.pending;
+  }
+
+  if (!waiting)
+    return -1;
+
+  uint64_t end = wm->scheduler.period_start_ns + wm->scheduler.period_ns;
+  uint64_t now = glps_frame_stats_now_ns();
+  return end > now ? glps_frame_stats_timeout_ms(end - now) : 0;
+}
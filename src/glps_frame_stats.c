@@ -0,0 +1,301 @@
+#include "glps_frame_stats.h"
+#include "utils/logger/pico_logger.h"
+
+#ifdef GLPS_USE_WIN32
+uint64_t glps_frame_stats_now_ns(void)
+{
+  static LARGE_INTEGER freq = {0};
+  LARGE_INTEGER counter;
+
+  if (freq.QuadPart == 0)
+  {
+    QueryPerformanceFrequency(&freq);
+  }
+  QueryPerformanceCounter(&counter);
+
+  return (uint64_t)((counter.QuadPart / freq.QuadPart) * 1000000000ull +
+                    (counter.QuadPart % freq.QuadPart) * 1000000000ull /
+                        freq.QuadPart);
+}
+#else
+#include <time.h>
+uint64_t glps_frame_stats_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+int glps_frame_stats_timeout_ms(uint64_t wait_ns)
+{
+  uint64_t ms = wait_ns / 1000000 + (wait_ns % 1000000 != 0);
+  return ms < INT_MAX ? (int)ms : INT_MAX;
+}
+
+static int __compare_u64(const void *a, const void *b)
+{
+  uint64_t lhs = *(const uint64_t *)a;
+  uint64_t rhs = *(const uint64_t *)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+static double __ns_to_ms(uint64_t ns) { return (double)ns / 1e6; }
+
+static double __percentile_ms(const uint64_t *sorted, size_t count,
+                              double percentile)
+{
+  size_t rank = (size_t)(percentile * (double)count + 0.999999);
+  if (rank == 0)
+    rank = 1;
+  if (rank > count)
+    rank = count;
+  return __ns_to_ms(sorted[rank - 1]);
+}
+
+void glps_frame_stats_init(glps_FrameStatsRing *ring)
+{
+  if (ring == NULL)
+    return;
+
+  memset(ring, 0, sizeof(*ring));
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->over_budget, 0);
+  atomic_init(&ring->gpu_head, 0);
+  atomic_init(&ring->gpu_dropped, 0);
+  atomic_init(&ring->budget_ns, GLPS_DEFAULT_FRAME_BUDGET_NS);
+}
+
+void glps_frame_stats_begin(glps_FrameStatsRing *ring)
+{
+  if (ring == NULL)
+    return;
+
+  ring->last_begin_ns = ring->begin_ns;
+  ring->begin_ns = glps_frame_stats_now_ns();
+}
+
+void glps_frame_stats_add_swap(glps_FrameStatsRing *ring, uint64_t swap_ns)
+{
+  if (ring == NULL)
+    return;
+
+  ring->pending_swap_ns += swap_ns;
+}
+
+void glps_frame_stats_end(glps_FrameStatsRing *ring)
+{
+  if (ring == NULL || ring->begin_ns == 0)
+    return;
+
+  uint64_t now = glps_frame_stats_now_ns();
+  uint64_t swap_ns = ring->pending_swap_ns;
+  uint64_t busy_ns = now - ring->begin_ns;
+  ring->pending_swap_ns = 0;
+
+  // The first frame has no predecessor to measure against.
+  if (ring->last_begin_ns == 0)
+    return;
+
+  uint64_t frame_ns = ring->begin_ns - ring->last_begin_ns;
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  size_t slot = (size_t)(head % GLPS_FRAME_STATS_CAPACITY);
+
+  ring->frame_ns[slot] = frame_ns;
+  ring->swap_ns[slot] = swap_ns;
+  ring->callback_ns[slot] = busy_ns > swap_ns ? busy_ns - swap_ns : 0;
+
+  uint64_t budget_ns =
+      atomic_load_explicit(&ring->budget_ns, memory_order_relaxed);
+  if (budget_ns != 0 && frame_ns > budget_ns)
+  {
+    atomic_fetch_add_explicit(&ring->over_budget, 1, memory_order_relaxed);
+  }
+
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+void glps_frame_stats_add_gpu(glps_FrameStatsRing *ring, uint64_t gpu_ns)
+{
+  if (ring == NULL)
+    return;
+
+  uint64_t head = atomic_load_explicit(&ring->gpu_head, memory_order_relaxed);
+  ring->gpu_ns[head % GLPS_FRAME_STATS_CAPACITY] = gpu_ns;
+  atomic_store_explicit(&ring->gpu_head, head + 1, memory_order_release);
+}
+
+void glps_frame_stats_drop_gpu(glps_FrameStatsRing *ring)
+{
+  if (ring == NULL)
+    return;
+
+  atomic_fetch_add_explicit(&ring->gpu_dropped, 1, memory_order_relaxed);
+}
+
+/* Copies the GPU samples of a ring and fills the GPU fields of a snapshot. */
+static void __snapshot_gpu(glps_FrameStatsRing *ring, glps_FrameStats *stats)
+{
+  uint64_t gpu_ns[GLPS_FRAME_STATS_CAPACITY];
+
+  uint64_t head = atomic_load_explicit(&ring->gpu_head, memory_order_acquire);
+  uint64_t count = head < GLPS_FRAME_STATS_CAPACITY ? head
+                                                   : GLPS_FRAME_STATS_CAPACITY;
+  uint64_t first = head - count;
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    gpu_ns[i] = ring->gpu_ns[(first + i) % GLPS_FRAME_STATS_CAPACITY];
+  }
+
+  atomic_thread_fence(memory_order_acquire);
+  uint64_t head_after =
+      atomic_load_explicit(&ring->gpu_head, memory_order_acquire);
+  uint64_t first_valid = head_after >= GLPS_FRAME_STATS_CAPACITY
+                             ? head_after - GLPS_FRAME_STATS_CAPACITY + 1
+                             : 0;
+  size_t skip = first_valid > first ? (size_t)(first_valid - first) : 0;
+  if (skip > count)
+    skip = (size_t)count;
+
+  size_t n = (size_t)count - skip;
+
+  stats->gpu_sample_count = n;
+  stats->gpu_dropped_frames =
+      atomic_load_explicit(&ring->gpu_dropped, memory_order_relaxed);
+
+  if (n == 0)
+    return;
+
+  uint64_t total_ns = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    total_ns += gpu_ns[skip + i];
+  }
+
+  qsort(gpu_ns + skip, n, sizeof(uint64_t), __compare_u64);
+
+  stats->gpu_mean_ms = __ns_to_ms(total_ns) / (double)n;
+  stats->gpu_p95_ms = __percentile_ms(gpu_ns + skip, n, 0.95);
+  stats->gpu_max_ms = __ns_to_ms(gpu_ns[skip + n - 1]);
+}
+
+void glps_frame_stats_histogram(glps_FrameStatsRing *ring,
+                                const uint64_t *edges_ns, size_t bucket_count,
+                                uint32_t *counts)
+{
+  uint64_t frame_ns[GLPS_FRAME_STATS_CAPACITY];
+
+  memset(counts, 0, bucket_count * sizeof(uint32_t));
+
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+  uint64_t count = head < GLPS_FRAME_STATS_CAPACITY ? head
+                                                   : GLPS_FRAME_STATS_CAPACITY;
+  uint64_t first = head - count;
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    frame_ns[i] = ring->frame_ns[(first + i) % GLPS_FRAME_STATS_CAPACITY];
+  }
+
+  atomic_thread_fence(memory_order_acquire);
+  uint64_t head_after = atomic_load_explicit(&ring->head, memory_order_acquire);
+  uint64_t first_valid = head_after >= GLPS_FRAME_STATS_CAPACITY
+                             ? head_after - GLPS_FRAME_STATS_CAPACITY + 1
+                             : 0;
+  size_t skip = first_valid > first ? (size_t)(first_valid - first) : 0;
+  if (skip > count)
+    skip = (size_t)count;
+
+  for (size_t i = skip; i < count; ++i)
+  {
+    size_t bucket = 0;
+    while (bucket + 1 < bucket_count && frame_ns[i] > edges_ns[bucket])
+      ++bucket;
+    ++counts[bucket];
+  }
+}
+
+void glps_frame_stats_snapshot(glps_FrameStatsRing *ring,
+                               glps_FrameStats *stats)
+{
+  if (stats == NULL)
+    return;
+
+  memset(stats, 0, sizeof(*stats));
+  if (ring == NULL)
+    return;
+
+  uint64_t frame_ns[GLPS_FRAME_STATS_CAPACITY];
+  uint64_t sorted_ns[GLPS_FRAME_STATS_CAPACITY];
+  uint64_t callback_ns[GLPS_FRAME_STATS_CAPACITY];
+  uint64_t swap_ns[GLPS_FRAME_STATS_CAPACITY];
+
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+  uint64_t count = head < GLPS_FRAME_STATS_CAPACITY ? head
+                                                   : GLPS_FRAME_STATS_CAPACITY;
+  uint64_t first = head - count;
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    size_t slot = (size_t)((first + i) % GLPS_FRAME_STATS_CAPACITY);
+    frame_ns[i] = ring->frame_ns[slot];
+    callback_ns[i] = ring->callback_ns[slot];
+    swap_ns[i] = ring->swap_ns[slot];
+  }
+
+  // Drop samples the writer may have overwritten while we were copying.
+  atomic_thread_fence(memory_order_acquire);
+  uint64_t head_after = atomic_load_explicit(&ring->head, memory_order_acquire);
+  uint64_t first_valid = head_after >= GLPS_FRAME_STATS_CAPACITY
+                             ? head_after - GLPS_FRAME_STATS_CAPACITY + 1
+                             : 0;
+  size_t skip = first_valid > first ? (size_t)(first_valid - first) : 0;
+  if (skip > count)
+    skip = (size_t)count;
+
+  size_t n = (size_t)count - skip;
+
+  stats->frame_count = head;
+  stats->sample_count = n;
+  stats->budget_ms = __ns_to_ms(
+      atomic_load_explicit(&ring->budget_ns, memory_order_relaxed));
+  stats->over_budget_frames =
+      atomic_load_explicit(&ring->over_budget, memory_order_relaxed);
+
+  __snapshot_gpu(ring, stats);
+
+  if (n == 0)
+    return;
+
+  uint64_t total_ns = 0, total_callback_ns = 0, total_swap_ns = 0;
+  uint64_t total_delta_ns = 0;
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    uint64_t f = frame_ns[skip + i];
+    sorted_ns[i] = f;
+    total_ns += f;
+    total_callback_ns += callback_ns[skip + i];
+    total_swap_ns += swap_ns[skip + i];
+
+    if (i > 0)
+    {
+      uint64_t prev = frame_ns[skip + i - 1];
+      total_delta_ns += f > prev ? f - prev : prev - f;
+    }
+  }
+
+  qsort(sorted_ns, n, sizeof(uint64_t), __compare_u64);
+
+  stats->mean_ms = __ns_to_ms(total_ns) / (double)n;
+  stats->fps = stats->mean_ms > 0.0 ? 1000.0 / stats->mean_ms : 0.0;
+  stats->p50_ms = __percentile_ms(sorted_ns, n, 0.50);
+  stats->p95_ms = __percentile_ms(sorted_ns, n, 0.95);
+  stats->p99_ms = __percentile_ms(sorted_ns, n, 0.99);
+  stats->max_ms = __ns_to_ms(sorted_ns[n - 1]);
+  stats->jitter_ms =
+      n > 1 ? __ns_to_ms(total_delta_ns) / (double)(n - 1) : 0.0;
+  stats->callback_cpu_ms = __ns_to_ms(total_callback_ns) / (double)n;
+  stats->swap_cpu_ms = __ns_to_ms(total_swap_ns) / (double)n;
+}
@@ -0,0 +1,207 @@
+#include "glps_gpu_timer.h"
+#include "glps_frame_stats.h"
+#include "glps_window_manager.h"
+#include "utils/logger/pico_logger.h"
+
+#ifdef GLPS_USE_WIN32
+#define GLPS_GL_APIENTRY __stdcall
+#else
+#define GLPS_GL_APIENTRY
+#endif
+
+#define GLPS_GL_VERSION 0x1F02
+#define GLPS_GL_EXTENSIONS 0x1F03
+#define GLPS_GL_TIMESTAMP 0x8E28
+#define GLPS_GL_QUERY_RESULT 0x8866
+#define GLPS_GL_QUERY_RESULT_AVAILABLE 0x8867
+
+typedef const unsigned char *(GLPS_GL_APIENTRY *glps_PFNGLGETSTRING)(
+    unsigned int name);
+typedef void(GLPS_GL_APIENTRY *glps_PFNGLGENQUERIES)(int n, unsigned int *ids);
+typedef void(GLPS_GL_APIENTRY *glps_PFNGLDELETEQUERIES)(int n,
+                                                        const unsigned int *ids);
+typedef void(GLPS_GL_APIENTRY *glps_PFNGLQUERYCOUNTER)(unsigned int id,
+                                                       unsigned int target);
+typedef void(GLPS_GL_APIENTRY *glps_PFNGLGETQUERYOBJECTIV)(unsigned int id,
+                                                           unsigned int pname,
+                                                           int *params);
+typedef void(GLPS_GL_APIENTRY *glps_PFNGLGETQUERYOBJECTUI64V)(
+    unsigned int id, unsigned int pname, uint64_t *params);
+
+static struct
+{
+  bool loaded;
+  bool supported;
+  bool es;
+  glps_PFNGLGENQUERIES gen_queries;
+  glps_PFNGLDELETEQUERIES delete_queries;
+  glps_PFNGLQUERYCOUNTER query_counter;
+  glps_PFNGLGETQUERYOBJECTIV get_query_objectiv;
+  glps_PFNGLGETQUERYOBJECTUI64V get_query_objectui64v;
+} gl;
+
+/* Looks up a core entry point, or its EXT_disjoint_timer_query name first
+ * on OpenGL ES, where the core names have no timestamp support. */
+static void *__load(const char *core_name, const char *ext_name)
+{
+  void *proc = glps_get_proc_addr(gl.es ? ext_name : core_name);
+  if (proc == NULL)
+    proc = glps_get_proc_addr(gl.es ? core_name : ext_name);
+  return proc;
+}
+
+static const char *__gl_string(unsigned int name)
+{
+#ifdef GLPS_USE_WIN32
+  // wglGetProcAddress() doesn't return OpenGL 1.1 entry points.
+  return (const char *)glGetString(name);
+#else
+  glps_PFNGLGETSTRING get_string =
+      (glps_PFNGLGETSTRING)glps_get_proc_addr("glGetString");
+  return get_string ? (const char *)get_string(name) : NULL;
+#endif
+}
+
+/* Whether the current context offers timestamp queries. Drivers hand out
+ * entry points for any name, so only the version and extensions tell. */
+static bool __has_timer_queries(void)
+{
+  const char *version = __gl_string(GLPS_GL_VERSION);
+  if (version == NULL)
+    return false;
+
+  const char *extensions = __gl_string(GLPS_GL_EXTENSIONS);
+  gl.es = strncmp(version, "OpenGL ES", 9) == 0;
+  if (gl.es)
+    return extensions && strstr(extensions, "GL_EXT_disjoint_timer_query");
+
+  int major = 0, minor = 0;
+  sscanf(version, "%d.%d", &major, &minor);
+  if (major > 3 || (major == 3 && minor >= 3))
+    return true;
+
+  return extensions && strstr(extensions, "GL_ARB_timer_query");
+}
+
+bool glps_gpu_timer_load(void)
+{
+  if (gl.loaded)
+    return gl.supported;
+
+  gl.loaded = true;
+  if (!__has_timer_queries())
+  {
+    LOG_WARNING("GL timer queries are not supported, GPU timing disabled.");
+    return false;
+  }
+
+  gl.gen_queries =
+      (glps_PFNGLGENQUERIES)__load("glGenQueries", "glGenQueriesEXT");
+  gl.delete_queries =
+      (glps_PFNGLDELETEQUERIES)__load("glDeleteQueries", "glDeleteQueriesEXT");
+  gl.query_counter =
+      (glps_PFNGLQUERYCOUNTER)__load("glQueryCounter", "glQueryCounterEXT");
+  gl.get_query_objectiv = (glps_PFNGLGETQUERYOBJECTIV)__load(
+      "glGetQueryObjectiv", "glGetQueryObjectivEXT");
+  gl.get_query_objectui64v = (glps_PFNGLGETQUERYOBJECTUI64V)__load(
+      "glGetQueryObjectui64v", "glGetQueryObjectui64vEXT");
+
+  gl.supported = gl.gen_queries && gl.delete_queries && gl.query_counter &&
+                 gl.get_query_objectiv && gl.get_query_objectui64v;
+  if (!gl.supported)
+  {
+    LOG_WARNING("GL timer queries are not supported, GPU timing disabled.");
+  }
+
+  return gl.supported;
+}
+
+/* Reads back every finished query pair, oldest first, without waiting. */
+static void __resolve(glps_GpuTimer *timer, glps_FrameStatsRing *ring)
+{
+  while (timer->resolved < timer->issued)
+  {
+    size_t slot = (size_t)(timer->resolved % GLPS_GPU_TIMER_LATENCY);
+    int available = 0;
+
+    gl.get_query_objectiv(timer->end_queries[slot],
+                          GLPS_GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+      break;
+
+    uint64_t begin_ns = 0, end_ns = 0;
+    gl.get_query_objectui64v(timer->begin_queries[slot], GLPS_GL_QUERY_RESULT,
+                             &begin_ns);
+    gl.get_query_objectui64v(timer->end_queries[slot], GLPS_GL_QUERY_RESULT,
+                             &end_ns);
+
+    glps_frame_stats_add_gpu(ring, end_ns > begin_ns ? end_ns - begin_ns : 0);
+    timer->resolved++;
+  }
+}
+
+void glps_gpu_timer_begin(glps_GpuTimer *timer, glps_FrameStatsRing *ring)
+{
+  if (timer == NULL || !timer->enabled)
+    return;
+
+  // A frame begun at the last swap restarts when the window's context is
+  // bound, so work drawn for other windows in between isn't counted.
+  if (timer->in_frame)
+  {
+    size_t slot = (size_t)(timer->issued % GLPS_GPU_TIMER_LATENCY);
+    gl.query_counter(timer->begin_queries[slot], GLPS_GL_TIMESTAMP);
+    return;
+  }
+
+  if (!glps_gpu_timer_load())
+  {
+    timer->enabled = false;
+    return;
+  }
+
+  if (!timer->created)
+  {
+    gl.gen_queries(GLPS_GPU_TIMER_LATENCY, timer->begin_queries);
+    gl.gen_queries(GLPS_GPU_TIMER_LATENCY, timer->end_queries);
+    timer->created = true;
+  }
+
+  __resolve(timer, ring);
+
+  // Every query is still in flight; skip this frame rather than stall.
+  if (timer->issued - timer->resolved >= GLPS_GPU_TIMER_LATENCY)
+  {
+    glps_frame_stats_drop_gpu(ring);
+    return;
+  }
+
+  size_t slot = (size_t)(timer->issued % GLPS_GPU_TIMER_LATENCY);
+  gl.query_counter(timer->begin_queries[slot], GLPS_GL_TIMESTAMP);
+  timer->in_frame = true;
+}
+
+void glps_gpu_timer_end(glps_GpuTimer *timer)
+{
+  if (timer == NULL || !timer->in_frame)
+    return;
+
+  size_t slot = (size_t)(timer->issued % GLPS_GPU_TIMER_LATENCY);
+  gl.query_counter(timer->end_queries[slot], GLPS_GL_TIMESTAMP);
+  timer->issued++;
+  timer->in_frame = false;
+}
+
+void glps_gpu_timer_destroy(glps_GpuTimer *timer)
+{
+  if (timer == NULL)
+    return;
+
+  if (timer->created)
+  {
+    gl.delete_queries(GLPS_GPU_TIMER_LATENCY, timer->begin_queries);
+    gl.delete_queries(GLPS_GPU_TIMER_LATENCY, timer->end_queries);
+  }
+
+  *timer = (glps_GpuTimer){0};
+}
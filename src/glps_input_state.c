@@ -0,0 +1,48 @@
+#include "glps_input_state.h"
+
+void glps_input_state_key(glps_InputState *state, unsigned long keycode,
+                          bool pressed)
+{
+  if (keycode >= GLPS_INPUT_KEY_COUNT)
+    return;
+
+  uint64_t bit = 1ull << (keycode % 64);
+  if (pressed)
+    state->keys[keycode / 64] |= bit;
+  else
+    state->keys[keycode / 64] &= ~bit;
+}
+
+void glps_input_state_button(glps_InputState *state, GLPS_MOUSE_BUTTON button,
+                             bool pressed)
+{
+  if ((int)button < 0 || button >= GLPS_MOUSE_BUTTON_COUNT)
+    return;
+
+  if (pressed)
+    state->buttons |= 1u << button;
+  else
+    state->buttons &= ~(1u << button);
+}
+
+void glps_input_state_motion(glps_InputState *state, double x, double y)
+{
+  state->pointer_x = x;
+  state->pointer_y = y;
+}
+
+void glps_input_state_scroll(glps_InputState *state, GLPS_SCROLL_AXES axis,
+                             double value)
+{
+  if (axis == GLPS_SCROLL_H_AXIS)
+    state->scroll_x += value;
+  else
+    state->scroll_y += value;
+}
+
+void glps_input_state_focus(glps_InputState *state, bool focused)
+{
+  state->keyboard_focus = focused;
+  if (!focused)
+    memset(state->keys, 0, sizeof(state->keys));
+}
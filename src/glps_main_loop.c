@@ -0,0 +1,137 @@
+#include "glps_main_loop.h"
+#include "glps_frame_stats.h"
+#include "glps_trace.h"
+
+#define GLPS_LOOP_DEFAULT_HZ 60.0
+#define GLPS_LOOP_DEFAULT_MAX_UPDATES 5
+#define GLPS_LOOP_DEFAULT_IDLE_SLICE_MS 1.0
+#define GLPS_LOOP_SMOOTHING 8 /**< A new sample weighs 1/8 in the averages. */
+
+static uint64_t __hz_to_ns(double hz)
+{
+  return (uint64_t)(1e9 / hz);
+}
+
+static uint64_t __smooth(uint64_t average, uint64_t sample)
+{
+  if (average == 0)
+    return sample;
+  return average - average / GLPS_LOOP_SMOOTHING + sample / GLPS_LOOP_SMOOTHING;
+}
+
+void glps_main_loop_init(glps_MainLoop *loop, const glps_LoopDesc *desc)
+{
+  memset(loop, 0, sizeof(*loop));
+  loop->desc = *desc;
+
+  if (loop->desc.update_hz <= 0.0)
+    loop->desc.update_hz = GLPS_LOOP_DEFAULT_HZ;
+  if (loop->desc.max_updates_per_frame == 0)
+    loop->desc.max_updates_per_frame = GLPS_LOOP_DEFAULT_MAX_UPDATES;
+  if (loop->desc.idle_slice_ms <= 0.0)
+    loop->desc.idle_slice_ms = GLPS_LOOP_DEFAULT_IDLE_SLICE_MS;
+
+  loop->step_ns = __hz_to_ns(loop->desc.update_hz);
+  loop->idle_slice_ns = (uint64_t)(loop->desc.idle_slice_ms * 1e6);
+  // Vsync paced loops start from a 60 Hz guess and measure from there.
+  loop->render_interval_ns = __hz_to_ns(
+      loop->desc.render_hz > 0.0 ? loop->desc.render_hz : GLPS_LOOP_DEFAULT_HZ);
+
+  loop->last_ns = glps_frame_stats_now_ns();
+  loop->next_render_ns = loop->last_ns;
+}
+
+static void __update(glps_MainLoop *loop, uint64_t now)
+{
+  uint64_t elapsed = now - loop->last_ns;
+  uint64_t max_elapsed = loop->step_ns * loop->desc.max_updates_per_frame;
+  loop->last_ns = now;
+
+  // After a stall, drop the time the simulation can't catch up on instead of
+  // spending every following frame on updates.
+  if (elapsed > max_elapsed)
+    elapsed = max_elapsed;
+  loop->accumulator_ns += elapsed;
+
+  double dt = (double)loop->step_ns / 1e9;
+  while (loop->accumulator_ns >= loop->step_ns)
+  {
+    if (loop->desc.update != NULL)
+      loop->desc.update(dt, loop->desc.data);
+    loop->accumulator_ns -= loop->step_ns;
+  }
+}
+
+static void __render(glps_MainLoop *loop, uint64_t now)
+{
+  bool vsync_paced = loop->desc.render_hz <= 0.0;
+  if (!vsync_paced && now < loop->next_render_ns)
+    return;
+
+  uint64_t start = glps_frame_stats_now_ns();
+  if (loop->desc.render != NULL)
+  {
+    double alpha = (double)loop->accumulator_ns / (double)loop->step_ns;
+    loop->desc.render(alpha, loop->desc.data);
+  }
+  uint64_t end = glps_frame_stats_now_ns();
+
+  loop->render_ns = __smooth(loop->render_ns, end - start);
+
+  if (vsync_paced)
+  {
+    // The swap returns at vsync, so render ends are one refresh apart.
+    if (loop->last_render_ns != 0)
+      loop->render_interval_ns =
+          __smooth(loop->render_interval_ns, end - loop->last_render_ns);
+    loop->next_render_ns = end + loop->render_interval_ns;
+  }
+  else
+  {
+    loop->next_render_ns += loop->render_interval_ns;
+    // Skip the slots that were missed rather than rendering back to back.
+    if (loop->next_render_ns <= end)
+      loop->next_render_ns = end + loop->render_interval_ns;
+  }
+  loop->last_render_ns = end;
+}
+
+/* Idle work has to stop early enough to leave the next render its usual
+ * time, capped at half a frame so a slow render doesn't starve idle work. */
+static uint64_t __idle_deadline(glps_MainLoop *loop)
+{
+  uint64_t reserve = loop->render_ns;
+  if (reserve > loop->render_interval_ns / 2)
+    reserve = loop->render_interval_ns / 2;
+  return loop->next_render_ns - reserve;
+}
+
+static void __idle(glps_MainLoop *loop, uint64_t deadline)
+{
+  if (loop->desc.idle == NULL)
+    return;
+
+  uint64_t span = GLPS_TRACE_BEGIN();
+  while (glps_frame_stats_now_ns() + loop->idle_slice_ns <= deadline)
+  {
+    if (!loop->desc.idle(loop->desc.data))
+      break;
+  }
+  GLPS_TRACE_END("idle", span);
+}
+
+uint64_t glps_main_loop_tick(glps_MainLoop *loop)
+{
+  uint64_t now = glps_frame_stats_now_ns();
+
+  uint64_t span = GLPS_TRACE_BEGIN();
+  __update(loop, now);
+  GLPS_TRACE_END("fixed_update", span);
+
+  __render(loop, now);
+
+  __idle(loop, __idle_deadline(loop));
+
+  now = glps_frame_stats_now_ns();
+  return loop->next_render_ns > now ? loop->next_render_ns - now : 0;
+}
@@ -0,0 +1,173 @@
+#define _GNU_SOURCE // memfd_create
+#include "glps_stats.h"
+#include "glps_frame_stats.h"
+#include "utils/logger/pico_logger.h"
+
+#ifndef GLPS_USE_WIN32
+#include <sys/mman.h>
+#endif
+
+/* Upper bounds of the frame-time buckets: around 240, 144, 120, 60, 50, 40,
+ * 30, 20, 15 and 10 Hz, then everything slower. */
+static const uint32_t histogram_edges_us[GLPS_STATS_HISTOGRAM_BUCKETS - 1] = {
+    4500, 7500, 9000, 17500, 21000, 26000, 34500, 51000, 68000, 101000};
+
+static atomic_uint_fast64_t counters[GLPS_STAT_COUNT];
+
+void glps_stats_add(GLPS_STAT stat, uint64_t count)
+{
+  atomic_fetch_add_explicit(&counters[stat], count, memory_order_relaxed);
+}
+
+#ifdef GLPS_USE_WIN32
+bool glps_stats_page_open(glps_StatsPublisher *publisher)
+{
+  (void)publisher;
+  LOG_WARNING("Stats page is not supported on this platform.");
+  return false;
+}
+
+void glps_stats_page_close(glps_StatsPublisher *publisher)
+{
+  (void)publisher;
+}
+#else
+bool glps_stats_page_open(glps_StatsPublisher *publisher)
+{
+  int fd = memfd_create(GLPS_STATS_PAGE_NAME, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0)
+  {
+    LOG_ERROR("Failed to create stats page: %s", strerror(errno));
+    return false;
+  }
+
+  if (ftruncate(fd, sizeof(glps_StatsPage)) != 0)
+  {
+    LOG_ERROR("Failed to size stats page: %s", strerror(errno));
+    close(fd);
+    return false;
+  }
+  // Readers map the whole page, so its size must never change under them.
+  fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+  glps_StatsPage *page = mmap(NULL, sizeof(glps_StatsPage),
+                              PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (page == MAP_FAILED)
+  {
+    LOG_ERROR("Failed to map stats page: %s", strerror(errno));
+    close(fd);
+    return false;
+  }
+
+  page->magic = GLPS_STATS_PAGE_MAGIC;
+  page->version = GLPS_STATS_PAGE_VERSION;
+  page->pid = (int32_t)getpid();
+  memcpy(page->histogram_edges_us, histogram_edges_us,
+         sizeof(histogram_edges_us));
+  atomic_init(&page->sequence, 0);
+
+  publisher->page = page;
+  publisher->fd = fd;
+  publisher->last_publish_ns = 0;
+  return true;
+}
+
+void glps_stats_page_close(glps_StatsPublisher *publisher)
+{
+  if (publisher->page == NULL)
+    return;
+
+  munmap(publisher->page, sizeof(glps_StatsPage));
+  close(publisher->fd);
+  publisher->page = NULL;
+  publisher->fd = -1;
+}
+#endif
+
+static uint32_t __display_events_pending(glps_WindowManager *wm)
+{
+#ifdef GLPS_USE_X11
+  glps_X11EventRing *ring = &wm->x11_ctx->events;
+  size_t in_ring = atomic_load_explicit(&ring->head, memory_order_acquire) -
+                   atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  // QueuedAlready only counts what was read, so this never touches the wire.
+  return (uint32_t)(in_ring + (size_t)XEventsQueued(wm->x11_ctx->display,
+                                                    QueuedAlready));
+#else
+  // libwayland and Win32 don't expose their queue lengths.
+  (void)wm;
+  return 0;
+#endif
+}
+
+static void __fill_window(glps_WindowManager *wm, size_t window_id,
+                          glps_StatsWindow *out)
+{
+  glps_FrameStatsRing *ring = &wm->windows[window_id]->frame_stats;
+  glps_FrameStats stats;
+  uint64_t edges_ns[GLPS_STATS_HISTOGRAM_BUCKETS - 1];
+
+  glps_frame_stats_snapshot(ring, &stats);
+  for (size_t i = 0; i < GLPS_STATS_HISTOGRAM_BUCKETS - 1; ++i)
+  {
+    edges_ns[i] = (uint64_t)histogram_edges_us[i] * 1000;
+  }
+
+  out->window_id = (uint32_t)window_id;
+  out->sample_count = (uint32_t)stats.sample_count;
+  out->frame_count = stats.frame_count;
+  out->over_budget_frames = stats.over_budget_frames;
+  out->fps = stats.fps;
+  out->mean_ms = stats.mean_ms;
+  out->p95_ms = stats.p95_ms;
+  out->p99_ms = stats.p99_ms;
+  out->max_ms = stats.max_ms;
+  glps_frame_stats_histogram(ring, edges_ns, GLPS_STATS_HISTOGRAM_BUCKETS,
+                             out->histogram);
+}
+
+void glps_stats_publish(glps_WindowManager *wm)
+{
+  glps_StatsPage *page = wm->stats.page;
+  if (page == NULL)
+    return;
+
+  uint64_t now = glps_frame_stats_now_ns();
+  if (now - wm->stats.last_publish_ns < GLPS_STATS_PUBLISH_NS)
+    return;
+  wm->stats.last_publish_ns = now;
+
+  // Everything is gathered before the page is marked busy, so readers retry
+  // for no longer than the copy below takes.
+  glps_StatsWindow windows[GLPS_STATS_MAX_WINDOWS];
+  uint32_t window_count = 0;
+  for (size_t i = 0;
+       i < wm->window_count && window_count < GLPS_STATS_MAX_WINDOWS; ++i)
+  {
+    if (wm->windows[i] != NULL)
+      __fill_window(wm, i, &windows[window_count++]);
+  }
+
+  uint32_t tasks_pending = (uint32_t)atomic_load_explicit(
+      &wm->event_loop.pending, memory_order_relaxed);
+  uint32_t display_events_pending = __display_events_pending(wm);
+
+  unsigned int sequence =
+      atomic_load_explicit(&page->sequence, memory_order_relaxed);
+  atomic_store_explicit(&page->sequence, sequence + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  page->publish_ns = now;
+  page->publish_count++;
+  page->tasks_pending = tasks_pending;
+  page->display_events_pending = display_events_pending;
+  page->total_coalesced_events = atomic_load_explicit(
+      &counters[GLPS_STAT_COALESCED_EVENTS], memory_order_relaxed);
+  page->total_audio_xruns = atomic_load_explicit(
+      &counters[GLPS_STAT_AUDIO_XRUNS], memory_order_relaxed);
+  page->total_log_dropped = get_dropped_log_count();
+  page->window_count = window_count;
+  memcpy(page->windows, windows, window_count * sizeof(glps_StatsWindow));
+
+  atomic_store_explicit(&page->sequence, sequence + 2, memory_order_release);
+}
@@ -0,0 +1,429 @@
+#include "glps_trace.h"
+#include "glps_frame_stats.h"
+#include "utils/logger/pico_logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef GLPS_USE_WIN32
+#include <windows.h>
+#define __trace_pid() ((uint32_t)GetCurrentProcessId())
+#define __trace_tid() ((uint32_t)GetCurrentThreadId())
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#define __trace_pid() ((uint32_t)getpid())
+#define __trace_tid() ((uint32_t)syscall(SYS_gettid))
+#endif
+
+typedef struct
+{
+  const char *name;
+  uint64_t start_ns;
+  uint64_t dur_ns;
+} glps_TraceSpan;
+
+typedef struct glps_TraceBuffer
+{
+  glps_TraceSpan spans[GLPS_TRACE_BUFFER_CAPACITY];
+  atomic_uint_fast64_t head; /**< Number of spans ever written. */
+  atomic_uint_fast64_t cleared; /**< Value of head at the last clear. */
+  uint32_t tid;
+  char thread_name[32];
+  struct glps_TraceBuffer *next;
+} glps_TraceBuffer;
+
+atomic_bool glps_trace_enabled_flag = false;
+
+static glps_TraceBuffer *_Atomic trace_buffers = NULL;
+static _Thread_local glps_TraceBuffer *thread_buffer = NULL;
+
+static glps_TraceBuffer *__get_thread_buffer(void)
+{
+  if (thread_buffer != NULL)
+    return thread_buffer;
+
+  glps_TraceBuffer *buffer = calloc(1, sizeof(glps_TraceBuffer));
+  if (buffer == NULL)
+  {
+    LOG_ERROR("Failed to allocate trace buffer.");
+    return NULL;
+  }
+
+  atomic_init(&buffer->head, 0);
+  atomic_init(&buffer->cleared, 0);
+  buffer->tid = __trace_tid();
+  snprintf(buffer->thread_name, sizeof(buffer->thread_name), "thread %u",
+           buffer->tid);
+
+  // Buffers are never freed, so a lock-free push is enough.
+  buffer->next = atomic_load(&trace_buffers);
+  while (!atomic_compare_exchange_weak(&trace_buffers, &buffer->next, buffer))
+  {
+  }
+
+  thread_buffer = buffer;
+  return buffer;
+}
+
+void glps_trace_enable(bool enabled)
+{
+  atomic_store(&glps_trace_enabled_flag, enabled);
+}
+
+uint64_t glps_trace_begin(void) { return glps_frame_stats_now_ns(); }
+
+void glps_trace_end(const char *name, uint64_t start_ns)
+{
+  glps_TraceBuffer *buffer = __get_thread_buffer();
+  if (buffer == NULL)
+    return;
+
+  uint64_t now = glps_frame_stats_now_ns();
+  uint64_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+  glps_TraceSpan *span = &buffer->spans[head % GLPS_TRACE_BUFFER_CAPACITY];
+
+  span->name = name;
+  span->start_ns = start_ns;
+  span->dur_ns = now > start_ns ? now - start_ns : 0;
+
+  atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+void glps_trace_set_thread_name(const char *name)
+{
+  glps_TraceBuffer *buffer = __get_thread_buffer();
+  if (buffer == NULL || name == NULL)
+    return;
+
+  snprintf(buffer->thread_name, sizeof(buffer->thread_name), "%s", name);
+}
+
+void glps_trace_clear(void)
+{
+  for (glps_TraceBuffer *buffer = atomic_load(&trace_buffers); buffer != NULL;
+       buffer = buffer->next)
+  {
+    // Only the owning thread writes head, so clearing marks where the kept
+    // spans start instead of rewinding it under a concurrent producer.
+    atomic_store(&buffer->cleared, atomic_load(&buffer->head));
+  }
+}
+
+/* Copies the spans of a buffer, oldest first. Returns the span count. */
+static size_t __copy_spans(glps_TraceBuffer *buffer, glps_TraceSpan *out)
+{
+  uint64_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+  uint64_t cleared = atomic_load(&buffer->cleared);
+  uint64_t count = head > cleared ? head - cleared : 0;
+  if (count > GLPS_TRACE_BUFFER_CAPACITY - 1)
+    count = GLPS_TRACE_BUFFER_CAPACITY - 1;
+
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    out[i] = buffer->spans[(head - count + i) % GLPS_TRACE_BUFFER_CAPACITY];
+  }
+  return (size_t)count;
+}
+
+static int __compare_spans(const void *a, const void *b)
+{
+  const glps_TraceSpan *lhs = a;
+  const glps_TraceSpan *rhs = b;
+
+  if (lhs->start_ns != rhs->start_ns)
+    return lhs->start_ns < rhs->start_ns ? -1 : 1;
+
+  // Parents first: on equal starts the longer span encloses the shorter one.
+  if (lhs->dur_ns != rhs->dur_ns)
+    return lhs->dur_ns > rhs->dur_ns ? -1 : 1;
+
+  return 0;
+}
+
+static void __write_json_string(FILE *file, const char *str)
+{
+  fputc('"', file);
+  for (; *str; ++str)
+  {
+    if (*str == '"' || *str == '\\')
+      fputc('\\', file);
+    if ((unsigned char)*str < 0x20)
+      continue;
+    fputc(*str, file);
+  }
+  fputc('"', file);
+}
+
+bool glps_trace_dump_chrome_json(const char *path)
+{
+  FILE *file = fopen(path, "w");
+  if (file == NULL)
+  {
+    LOG_ERROR("Couldn't open trace file %s.", path);
+    return false;
+  }
+
+  glps_TraceSpan *spans = malloc(sizeof(glps_TraceSpan) * GLPS_TRACE_BUFFER_CAPACITY);
+  if (spans == NULL)
+  {
+    LOG_ERROR("Failed to allocate trace export buffer.");
+    fclose(file);
+    return false;
+  }
+
+  uint32_t pid = __trace_pid();
+  bool first = true;
+
+  fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+  for (glps_TraceBuffer *buffer = atomic_load(&trace_buffers); buffer != NULL;
+       buffer = buffer->next)
+  {
+    fprintf(file,
+            "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,"
+            "\"args\":{\"name\":",
+            first ? "" : ",", pid, buffer->tid);
+    __write_json_string(file, buffer->thread_name);
+    fprintf(file, "}}");
+    first = false;
+
+    size_t count = __copy_spans(buffer, spans);
+    for (size_t i = 0; i < count; ++i)
+    {
+      fprintf(file, ",\n{\"name\":");
+      __write_json_string(file, spans[i].name);
+      fprintf(file,
+              ",\"cat\":\"glps\",\"ph\":\"X\",\"ts\":%llu.%03u,"
+              "\"dur\":%llu.%03u,\"pid\":%u,\"tid\":%u}",
+              (unsigned long long)(spans[i].start_ns / 1000),
+              (unsigned)(spans[i].start_ns % 1000),
+              (unsigned long long)(spans[i].dur_ns / 1000),
+              (unsigned)(spans[i].dur_ns % 1000), pid, buffer->tid);
+    }
+  }
+
+  fprintf(file, "\n]}\n");
+
+  free(spans);
+  return fclose(file) == 0;
+}
+
+/* ======= Minimal protobuf writer for the Perfetto trace format ======= */
+
+typedef struct
+{
+  uint8_t *data;
+  size_t size;
+  size_t capacity;
+  bool failed;
+} glps_PbBuffer;
+
+static void __pb_put(glps_PbBuffer *pb, const void *data, size_t size)
+{
+  if (pb->failed)
+    return;
+
+  if (pb->size + size > pb->capacity)
+  {
+    size_t capacity = pb->capacity ? pb->capacity * 2 : 256;
+    while (capacity < pb->size + size)
+      capacity *= 2;
+
+    uint8_t *grown = realloc(pb->data, capacity);
+    if (grown == NULL)
+    {
+      pb->failed = true;
+      return;
+    }
+    pb->data = grown;
+    pb->capacity = capacity;
+  }
+
+  memcpy(pb->data + pb->size, data, size);
+  pb->size += size;
+}
+
+static void __pb_varint(glps_PbBuffer *pb, uint64_t value)
+{
+  uint8_t bytes[10];
+  size_t n = 0;
+  do
+  {
+    bytes[n] = (uint8_t)(value & 0x7f);
+    value >>= 7;
+    if (value)
+      bytes[n] |= 0x80;
+    n++;
+  } while (value);
+  __pb_put(pb, bytes, n);
+}
+
+static void __pb_uint(glps_PbBuffer *pb, uint32_t field, uint64_t value)
+{
+  __pb_varint(pb, (uint64_t)field << 3);
+  __pb_varint(pb, value);
+}
+
+static void __pb_bytes(glps_PbBuffer *pb, uint32_t field, const void *data,
+                       size_t size)
+{
+  __pb_varint(pb, ((uint64_t)field << 3) | 2);
+  __pb_varint(pb, size);
+  __pb_put(pb, data, size);
+}
+
+static void __pb_string(glps_PbBuffer *pb, uint32_t field, const char *str)
+{
+  __pb_bytes(pb, field, str, strlen(str));
+}
+
+/* Field numbers from perfetto/protos/perfetto/trace/. */
+enum
+{
+  PB_TRACE_PACKET = 1,
+  PB_PACKET_TIMESTAMP = 8,
+  PB_PACKET_SEQUENCE_ID = 10,
+  PB_PACKET_TRACK_EVENT = 11,
+  PB_PACKET_TRACK_DESCRIPTOR = 60,
+  PB_TRACK_UUID = 1,
+  PB_TRACK_NAME = 2,
+  PB_TRACK_THREAD = 4,
+  PB_THREAD_PID = 1,
+  PB_THREAD_TID = 2,
+  PB_THREAD_NAME = 5,
+  PB_EVENT_TYPE = 9,
+  PB_EVENT_TRACK_UUID = 11,
+  PB_EVENT_CATEGORY = 22,
+  PB_EVENT_NAME = 23,
+  PB_EVENT_SLICE_BEGIN = 1,
+  PB_EVENT_SLICE_END = 2,
+};
+
+#define GLPS_TRACE_SEQUENCE_ID 0x474c5053u
+
+static void __pb_packet(glps_PbBuffer *out, glps_PbBuffer *packet)
+{
+  if (packet->failed)
+  {
+    out->failed = true;
+    return;
+  }
+  __pb_bytes(out, PB_TRACE_PACKET, packet->data, packet->size);
+  packet->size = 0;
+}
+
+static void __pb_slice(glps_PbBuffer *out, glps_PbBuffer *packet,
+                       glps_PbBuffer *event, uint64_t track_uuid, int type,
+                       const char *name, uint64_t ts)
+{
+  event->size = 0;
+  __pb_uint(event, PB_EVENT_TYPE, (uint64_t)type);
+  __pb_uint(event, PB_EVENT_TRACK_UUID, track_uuid);
+  if (type == PB_EVENT_SLICE_BEGIN)
+  {
+    __pb_string(event, PB_EVENT_CATEGORY, "glps");
+    __pb_string(event, PB_EVENT_NAME, name);
+  }
+  if (event->failed)
+  {
+    out->failed = true;
+    return;
+  }
+
+  __pb_uint(packet, PB_PACKET_TIMESTAMP, ts);
+  __pb_uint(packet, PB_PACKET_SEQUENCE_ID, GLPS_TRACE_SEQUENCE_ID);
+  __pb_bytes(packet, PB_PACKET_TRACK_EVENT, event->data, event->size);
+  __pb_packet(out, packet);
+}
+
+bool glps_trace_dump_perfetto(const char *path)
+{
+  glps_TraceSpan *spans = malloc(sizeof(glps_TraceSpan) * GLPS_TRACE_BUFFER_CAPACITY);
+  glps_TraceSpan **open = malloc(sizeof(glps_TraceSpan *) * GLPS_TRACE_BUFFER_CAPACITY);
+  if (spans == NULL || open == NULL)
+  {
+    LOG_ERROR("Failed to allocate trace export buffer.");
+    free(spans);
+    free(open);
+    return false;
+  }
+
+  glps_PbBuffer out = {0}, packet = {0}, nested = {0}, event = {0};
+  uint32_t pid = __trace_pid();
+
+  for (glps_TraceBuffer *buffer = atomic_load(&trace_buffers); buffer != NULL;
+       buffer = buffer->next)
+  {
+    uint64_t track_uuid = ((uint64_t)pid << 32) | buffer->tid;
+
+    nested.size = 0;
+    __pb_uint(&nested, PB_THREAD_PID, pid);
+    __pb_uint(&nested, PB_THREAD_TID, buffer->tid);
+    __pb_string(&nested, PB_THREAD_NAME, buffer->thread_name);
+
+    event.size = 0;
+    __pb_uint(&event, PB_TRACK_UUID, track_uuid);
+    __pb_string(&event, PB_TRACK_NAME, buffer->thread_name);
+    __pb_bytes(&event, PB_TRACK_THREAD, nested.data, nested.size);
+
+    __pb_uint(&packet, PB_PACKET_SEQUENCE_ID, GLPS_TRACE_SEQUENCE_ID);
+    __pb_bytes(&packet, PB_PACKET_TRACK_DESCRIPTOR, event.data, event.size);
+    __pb_packet(&out, &packet);
+
+    // Slices on a track must nest, so replay them in start order and close
+    // every open slice that ends before the next one starts.
+    size_t count = __copy_spans(buffer, spans);
+    size_t depth = 0;
+    qsort(spans, count, sizeof(glps_TraceSpan), __compare_spans);
+
+    for (size_t i = 0; i <= count; ++i)
+    {
+      uint64_t next_start = i < count ? spans[i].start_ns : UINT64_MAX;
+
+      while (depth > 0 &&
+             open[depth - 1]->start_ns + open[depth - 1]->dur_ns <= next_start)
+      {
+        glps_TraceSpan *done = open[--depth];
+        __pb_slice(&out, &packet, &event, track_uuid, PB_EVENT_SLICE_END,
+                   done->name, done->start_ns + done->dur_ns);
+      }
+
+      if (i < count)
+      {
+        __pb_slice(&out, &packet, &event, track_uuid, PB_EVENT_SLICE_BEGIN,
+                   spans[i].name, spans[i].start_ns);
+        open[depth++] = &spans[i];
+      }
+    }
+  }
+
+  bool ok = !out.failed;
+  if (ok)
+  {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+      LOG_ERROR("Couldn't open trace file %s.", path);
+      ok = false;
+    }
+    else
+    {
+      ok = fwrite(out.data, 1, out.size, file) == out.size;
+      ok = fclose(file) == 0 && ok;
+    }
+  }
+  else
+  {
+    LOG_ERROR("Failed to encode Perfetto trace.");
+  }
+
+  free(out.data);
+  free(packet.data);
+  free(nested.data);
+  free(event.data);
+  free(spans);
+  free(open);
+  return ok;
+}
@@ -1,7 +1,28 @@
+#include <glps_dynamic_resolution.h>
 #include <glps_egl_context.h>
+#include <glps_event_loop.h>
+#include <glps_frame_scheduler.h>
+#include <glps_frame_stats.h>
+#include <glps_gpu_timer.h>
+#include <glps_input_state.h>
+#include <glps_trace.h>
 #include <glps_wayland.h>
+#include <linux/input-event-codes.h>
+#include <math.h>
+#include <poll.h>
 #include "utils/logger/pico_logger.h"
 
+/* The suspended toplevel state needs xdg_wm_base v6; older protocol headers
+ * fall back to v1, where it is never sent. */
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+#define GLPS_XDG_WM_BASE_VERSION XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+#else
+#define GLPS_XDG_WM_BASE_VERSION 1
+#endif
+
+/* A window whose frame callbacks stop for this long is treated as hidden. */
+#define GLPS_FRAME_STALL_NS 1000000000ull
+
 void xdg_wm_base_ping(void *data, struct xdg_wm_base *xdg_wm_base,
                       uint32_t serial)
 {
@@ -66,10 +87,11 @@ ssize_t __get_window_id_from_xdg_surface(glps_WindowManager *wm,
   return -1;
 }
 
-void __window_destroy(glps_WindowManager *wm, size_t window_id)
+/* Destroys the protocol and EGL objects of a window and frees it. */
+static void __window_free(glps_WindowManager *wm, glps_WaylandWindow *window)
 {
+  glps_gpu_timer_destroy(&window->gpu_timer);
 
-  glps_WaylandWindow *window = wm->windows[window_id];
   if (window->frame_args != NULL)
   {
     free(window->frame_args);
@@ -88,15 +110,70 @@ void __window_destroy(glps_WindowManager *wm, size_t window_id)
     window->frame_callback = NULL;
   }
 
-  // eglDestroySurface(wm->egl_ctx->dpy, window->egl_surface);
+  // The EGL surface must go before the native window it draws to.
+  if (window->egl_surface != EGL_NO_SURFACE && wm->egl_ctx != NULL)
+  {
+    if (eglGetCurrentSurface(EGL_DRAW) == window->egl_surface)
+    {
+      eglMakeCurrent(wm->egl_ctx->dpy, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                     EGL_NO_CONTEXT);
+    }
+    eglDestroySurface(wm->egl_ctx->dpy, window->egl_surface);
+    window->egl_surface = EGL_NO_SURFACE;
+  }
   wl_egl_window_destroy(window->egl_window);
 
-  xdg_toplevel_destroy(window->xdg_toplevel);
-  xdg_surface_destroy(window->xdg_surface);
+  if (window->xdg_popup != NULL)
+  {
+    xdg_popup_destroy(window->xdg_popup);
+    window->xdg_popup = NULL;
+  }
+  if (window->xdg_toplevel != NULL)
+  {
+    xdg_toplevel_destroy(window->xdg_toplevel);
+    window->xdg_toplevel = NULL;
+  }
+  if (window->xdg_surface != NULL)
+  {
+    xdg_surface_destroy(window->xdg_surface);
+    window->xdg_surface = NULL;
+  }
+  if (window->subsurface != NULL)
+  {
+    wl_subsurface_destroy(window->subsurface);
+    window->subsurface = NULL;
+  }
+  if (window->viewport != NULL)
+  {
+    wp_viewport_destroy(window->viewport);
+    window->viewport = NULL;
+  }
+
+  if (window->fractional_scale != NULL)
+  {
+    wp_fractional_scale_v1_destroy(window->fractional_scale);
+    window->fractional_scale = NULL;
+  }
+
   wl_surface_destroy(window->wl_surface);
 
   free(window);
+}
+
+void __window_destroy(glps_WindowManager *wm, size_t window_id)
+{
+  glps_WaylandWindow *window = wm->windows[window_id];
+
+  // Popups must be destroyed before the surface they are attached to.
+  for (size_t i = 0; i < wm->window_count; ++i)
+  {
+    if (wm->windows[i] != NULL && wm->windows[i]->parent == window)
+    {
+      __window_destroy(wm, i);
+    }
+  }
 
+  __window_free(wm, window);
   wm->windows[window_id] = NULL;
 
   if (window_id == 0)
@@ -114,12 +191,118 @@ void wl_update(glps_WindowManager *wm, size_t window_id)
     return;
   }
 
+  // A buffer committed before the initial configure is a protocol error.
+  if (wm->windows[window_id]->awaiting_map)
+  {
+    return;
+  }
+
   int width = wm->windows[window_id]->properties.width,
       height = wm->windows[window_id]->properties.height;
   wl_surface_damage(wm->windows[window_id]->wl_surface, 0, 0, width, height);
   wl_surface_commit(wm->windows[window_id]->wl_surface);
 }
 
+/* Requests the next frame callback of a window unless one is pending. */
+static void __arm_frame_callback(glps_WaylandWindow *window)
+{
+  if (window->frame_callback != NULL || window->wl_surface == NULL)
+    return;
+
+  window->frame_callback = wl_surface_frame(window->wl_surface);
+  if (window->frame_callback)
+  {
+    wl_callback_add_listener(window->frame_callback, &frame_callback_listener,
+                             window->frame_args);
+  }
+  // Stalls are measured from when a frame was last asked for.
+  window->last_frame_done_ns = glps_frame_stats_now_ns();
+}
+
+void glps_wl_window_request_redraw(glps_WindowManager *wm, size_t window_id)
+{
+  if (window_id >= wm->window_count || wm->windows[window_id] == NULL)
+    return;
+
+  glps_WaylandWindow *window = wm->windows[window_id];
+  window->redraw_requested = true;
+
+  // A pending frame callback picks the request up; requests merge into it.
+  if (window->frame_callback != NULL || window->hidden_reasons != 0)
+    return;
+
+  __arm_frame_callback(window);
+  wl_update(wm, window_id);
+}
+
+/* Sizes the EGL buffer to the logical size times the render scale and lets
+ * the viewport stretch it back to the logical size. The buffer is relative
+ * to the logical size applications are told about, never to the output
+ * scale, so lowering the render scale always lowers the pixel count. */
+static void __apply_render_scale(glps_WaylandWindow *window)
+{
+  double scale = window->render_scale;
+
+  // Without a viewport the compositor would show the buffer at its own size.
+  if (window->viewport == NULL)
+    scale = 1.0;
+
+  int width = window->properties.width;
+  int height = window->properties.height;
+  int buffer_width, buffer_height;
+  glps_dynamic_resolution_buffer_size(width, height, scale, &buffer_width,
+                                      &buffer_height);
+
+  window->buffer_width = buffer_width > 0 ? buffer_width : 1;
+  window->buffer_height = buffer_height > 0 ? buffer_height : 1;
+
+  if (window->egl_window != NULL)
+  {
+    wl_egl_window_resize(window->egl_window, window->buffer_width,
+                         window->buffer_height, 0, 0);
+  }
+
+  if (window->viewport != NULL && width > 0 && height > 0)
+  {
+    wp_viewport_set_destination(window->viewport, width, height);
+  }
+}
+
+static void fractional_scale_preferred_scale(
+    void *data, struct wp_fractional_scale_v1 *fractional_scale,
+    uint32_t scale)
+{
+  glps_WaylandWindow *window = (glps_WaylandWindow *)data;
+
+  // The scale is sent in 1/120ths. Only the cursor follows it.
+  window->preferred_scale = (double)scale / 120.0;
+}
+
+struct wp_fractional_scale_v1_listener fractional_scale_listener = {
+    .preferred_scale = fractional_scale_preferred_scale,
+};
+
+void glps_wl_window_set_render_scale(glps_WindowManager *wm, size_t window_id,
+                                     double scale)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
+  {
+    LOG_ERROR("Couldn't set render scale. Invalid parameters.");
+    return;
+  }
+
+  glps_WaylandWindow *window = wm->windows[window_id];
+
+  if (window->viewport == NULL && scale != 1.0)
+  {
+    LOG_WARNING("wp_viewporter is unavailable, rendering at full scale.");
+  }
+
+  window->render_scale = scale;
+  __apply_render_scale(window);
+}
+
 ssize_t __get_window_id_from_xdg_toplevel(glps_WindowManager *wm,
                                           struct xdg_toplevel *toplevel)
 {
@@ -144,6 +327,242 @@ ssize_t __get_window_id_from_xdg_toplevel(glps_WindowManager *wm,
 }
 
 struct wl_callback_listener frame_callback_listener;
+/* Theme names per GLPS_CURSOR_TYPE: the CSS name first, then the legacy X
+ * name older themes ship. */
+static const char *__cursor_names[GLPS_CURSOR_TYPE_COUNT][2] = {
+    [GLPS_CURSOR_ARROW] = {"default", "left_ptr"},
+    [GLPS_CURSOR_IBEAM] = {"text", "xterm"},
+    [GLPS_CURSOR_CROSSHAIR] = {"crosshair", "cross"},
+    [GLPS_CURSOR_HAND] = {"pointer", "hand2"},
+    [GLPS_CURSOR_HRESIZE] = {"ew-resize", "sb_h_double_arrow"},
+    [GLPS_CURSOR_VRESIZE] = {"ns-resize", "sb_v_double_arrow"},
+    [GLPS_CURSOR_NOT_ALLOWED] = {"not-allowed", "crossed_circle"},
+};
+
+/* Integer scale of the window under the pointer, which cursor buffers are
+ * decoded at. */
+static int __cursor_scale(glps_WindowManager *wm)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+  int scale = 1;
+
+  // wl_surface.set_buffer_scale needs wl_compositor v3.
+  if (ctx->compositor_version < 3)
+    return 1;
+
+  size_t window_id = ctx->mouse_window_id;
+  if (window_id < wm->window_count && wm->windows[window_id] != NULL)
+  {
+    double preferred = wm->windows[window_id]->preferred_scale;
+
+    // Without fractional-scale-v1 only the output's integer scale is known.
+    glps_Output output;
+    if (wm->windows[window_id]->fractional_scale == NULL &&
+        glps_wl_window_get_output(wm, window_id, &output))
+    {
+      preferred = output.scale;
+    }
+
+    scale = (int)ceil(preferred);
+  }
+
+  if (scale < 1)
+    scale = 1;
+  if (scale > GLPS_MAX_CURSOR_SCALE)
+    scale = GLPS_MAX_CURSOR_SCALE;
+  return scale;
+}
+
+/* Returns the cursor of a type at a scale, loading the theme on first use. */
+static struct wl_cursor *__get_cursor(glps_WindowManager *wm,
+                                      GLPS_CURSOR_TYPE type, int scale)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+  struct wl_cursor **cached = &ctx->cursors[scale - 1][type];
+
+  if (*cached != NULL)
+    return *cached;
+
+  if (ctx->cursor_themes[scale - 1] == NULL)
+  {
+    const char *theme_name = getenv("XCURSOR_THEME");
+    const char *size_env = getenv("XCURSOR_SIZE");
+    int size = size_env != NULL ? atoi(size_env) : 0;
+    if (size <= 0)
+      size = GLPS_DEFAULT_CURSOR_SIZE;
+
+    ctx->cursor_themes[scale - 1] =
+        wl_cursor_theme_load(theme_name, size * scale, ctx->wl_shm);
+    if (ctx->cursor_themes[scale - 1] == NULL)
+    {
+      LOG_ERROR("Failed to load cursor theme.");
+      return NULL;
+    }
+  }
+
+  for (size_t i = 0; i < 2 && *cached == NULL; ++i)
+  {
+    *cached = wl_cursor_theme_get_cursor(ctx->cursor_themes[scale - 1],
+                                         __cursor_names[type][i]);
+  }
+
+  // Fall back to the arrow rather than leaving the pointer without a cursor.
+  if (*cached == NULL && type != GLPS_CURSOR_ARROW)
+  {
+    LOG_WARNING("Cursor theme lacks %s, using the arrow.",
+                __cursor_names[type][0]);
+    *cached = __get_cursor(wm, GLPS_CURSOR_ARROW, scale);
+  }
+
+  return *cached;
+}
+
+/* Attaches an image of the current cursor to the cursor surface. Returns
+ * whether the hotspot moved, which needs a new wl_pointer.set_cursor. */
+static bool __attach_cursor_image(glps_WaylandContext *ctx, unsigned int frame)
+{
+  struct wl_cursor_image *image = ctx->cursor->images[frame];
+  struct wl_buffer *buffer = wl_cursor_image_get_buffer(image);
+  int scale = ctx->cursor_scale;
+
+  wl_surface_attach(ctx->cursor_surface, buffer, 0, 0);
+  if (ctx->compositor_version >= 3)
+  {
+    wl_surface_set_buffer_scale(ctx->cursor_surface, scale);
+  }
+  wl_surface_damage(ctx->cursor_surface, 0, 0, INT32_MAX, INT32_MAX);
+
+  int hotspot_x = (int)image->hotspot_x / scale;
+  int hotspot_y = (int)image->hotspot_y / scale;
+  bool moved = hotspot_x != ctx->cursor_hotspot_x ||
+               hotspot_y != ctx->cursor_hotspot_y;
+  ctx->cursor_hotspot_x = hotspot_x;
+  ctx->cursor_hotspot_y = hotspot_y;
+  ctx->cursor_frame = frame;
+  return moved;
+}
+
+static void cursor_frame_done(void *data, struct wl_callback *callback,
+                              uint32_t time);
+
+static const struct wl_callback_listener cursor_frame_listener = {
+    .done = cursor_frame_done,
+};
+
+static void __stop_cursor_animation(glps_WaylandContext *ctx)
+{
+  if (ctx->cursor_frame_callback != NULL)
+  {
+    wl_callback_destroy(ctx->cursor_frame_callback);
+    ctx->cursor_frame_callback = NULL;
+  }
+}
+
+static void cursor_frame_done(void *data, struct wl_callback *callback,
+                              uint32_t time)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+
+  wl_callback_destroy(callback);
+  ctx->cursor_frame_callback = NULL;
+
+  if (ctx->cursor == NULL || ctx->cursor->image_count < 2 ||
+      ctx->wl_pointer == NULL || ctx->pointer_enter_serial == 0)
+    return;
+
+  if (ctx->cursor_start_ms == 0)
+    ctx->cursor_start_ms = time;
+
+  // The compositor paces the animation; only commit when the image changes.
+  unsigned int frame =
+      (unsigned int)wl_cursor_frame(ctx->cursor, time - ctx->cursor_start_ms);
+  if (frame != ctx->cursor_frame &&
+      __attach_cursor_image(ctx, frame))
+  {
+    wl_pointer_set_cursor(ctx->wl_pointer, ctx->pointer_enter_serial,
+                          ctx->cursor_surface, ctx->cursor_hotspot_x,
+                          ctx->cursor_hotspot_y);
+  }
+
+  ctx->cursor_frame_callback = wl_surface_frame(ctx->cursor_surface);
+  wl_callback_add_listener(ctx->cursor_frame_callback, &cursor_frame_listener,
+                           wm);
+  wl_surface_commit(ctx->cursor_surface);
+}
+
+/* Shows the selected cursor. Unless forced, nothing is sent when the pointer
+ * already shows it. */
+static void __update_cursor(glps_WindowManager *wm, bool force)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+
+  // The cursor can only be set while the pointer is over one of our surfaces.
+  if (ctx->wl_pointer == NULL || ctx->pointer_enter_serial == 0 ||
+      ctx->wl_shm == NULL)
+    return;
+
+  int scale = __cursor_scale(wm);
+  struct wl_cursor *cursor = __get_cursor(wm, ctx->cursor_type, scale);
+  if (cursor == NULL || cursor->image_count == 0)
+    return;
+
+  if (!force && cursor == ctx->cursor && scale == ctx->cursor_scale)
+    return;
+
+  if (ctx->cursor_surface == NULL)
+  {
+    ctx->cursor_surface = wl_compositor_create_surface(ctx->wl_compositor);
+    if (ctx->cursor_surface == NULL)
+    {
+      LOG_ERROR("Failed to create cursor surface.");
+      return;
+    }
+  }
+
+  __stop_cursor_animation(ctx);
+  ctx->cursor = cursor;
+  ctx->cursor_scale = scale;
+  ctx->cursor_start_ms = 0;
+
+  __attach_cursor_image(ctx, 0);
+  wl_pointer_set_cursor(ctx->wl_pointer, ctx->pointer_enter_serial,
+                        ctx->cursor_surface, ctx->cursor_hotspot_x,
+                        ctx->cursor_hotspot_y);
+
+  if (cursor->image_count > 1)
+  {
+    ctx->cursor_frame_callback = wl_surface_frame(ctx->cursor_surface);
+    wl_callback_add_listener(ctx->cursor_frame_callback,
+                             &cursor_frame_listener, wm);
+  }
+
+  wl_surface_commit(ctx->cursor_surface);
+}
+
+static void __destroy_cursors(glps_WaylandContext *ctx)
+{
+  __stop_cursor_animation(ctx);
+
+  if (ctx->cursor_surface != NULL)
+  {
+    wl_surface_destroy(ctx->cursor_surface);
+    ctx->cursor_surface = NULL;
+  }
+
+  for (int i = 0; i < GLPS_MAX_CURSOR_SCALE; ++i)
+  {
+    if (ctx->cursor_themes[i] != NULL)
+    {
+      wl_cursor_theme_destroy(ctx->cursor_themes[i]);
+      ctx->cursor_themes[i] = NULL;
+    }
+  }
+
+  memset(ctx->cursors, 0, sizeof(ctx->cursors));
+  ctx->cursor = NULL;
+}
+
 void wl_pointer_enter(void *data, struct wl_pointer *wl_pointer,
                       uint32_t serial, struct wl_surface *surface,
                       wl_fixed_t surface_x, wl_fixed_t surface_y)
@@ -172,6 +591,10 @@ void wl_pointer_enter(void *data, struct wl_pointer *wl_pointer,
   }
 
   wayland_context->mouse_window_id = (size_t)window_id;
+
+  // Every enter carries a new serial the cursor has to be set with.
+  wayland_context->pointer_enter_serial = serial;
+  __update_cursor(context, true);
 }
 
 void wl_pointer_leave(void *data, struct wl_pointer *wl_pointer,
@@ -180,6 +603,9 @@ void wl_pointer_leave(void *data, struct wl_pointer *wl_pointer,
   glps_WindowManager *context = (glps_WindowManager *)data;
   context->pointer_event.serial = serial;
   context->pointer_event.event_mask |= POINTER_EVENT_LEAVE;
+
+  context->wayland_ctx->pointer_enter_serial = 0;
+  __stop_cursor_animation(context->wayland_ctx);
 }
 
 void wl_pointer_motion(void *data, struct wl_pointer *wl_pointer, uint32_t time,
@@ -201,6 +627,10 @@ void wl_pointer_button(void *data, struct wl_pointer *wl_pointer,
   context->pointer_event.time = time;
   context->pointer_event.serial = serial;
   context->pointer_event.button = button, context->pointer_event.state = state;
+  if (state == WL_POINTER_BUTTON_STATE_PRESSED && context->wayland_ctx)
+  {
+    context->wayland_ctx->press_serial = serial;
+  }
 }
 
 void wl_pointer_axis(void *data, struct wl_pointer *wl_pointer, uint32_t time,
@@ -239,6 +669,108 @@ void wl_pointer_axis_discrete(void *data, struct wl_pointer *wl_pointer,
   context->pointer_event.axes[axis].discrete = discrete;
 }
 
+/* Input state of a window, NULL if the window is gone. */
+static glps_InputState *__input_state(glps_WindowManager *wm, size_t window_id)
+{
+  if (window_id >= wm->window_count || wm->windows[window_id] == NULL)
+    return NULL;
+  return &wm->windows[window_id]->input;
+}
+
+/* Whether a window exists and subscribed to any class in mask. */
+static bool __wants_events(glps_WindowManager *wm, size_t window_id,
+                           unsigned int mask)
+{
+  return window_id < wm->window_count && wm->windows[window_id] != NULL &&
+         (wm->windows[window_id]->event_mask & mask);
+}
+
+/* Pointer frame events delivering the GLPS event classes in mask. */
+static uint32_t __pointer_event_filter(unsigned int mask)
+{
+  uint32_t filter = 0;
+
+  if (mask & GLPS_EVENT_POINTER_CROSSING)
+    filter |= POINTER_EVENT_ENTER | POINTER_EVENT_LEAVE;
+  if (mask & GLPS_EVENT_POINTER_MOTION)
+    filter |= POINTER_EVENT_MOTION;
+  if (mask & GLPS_EVENT_POINTER_BUTTON)
+    filter |= POINTER_EVENT_BUTTON;
+  if (mask & GLPS_EVENT_POINTER_SCROLL)
+    filter |= POINTER_EVENT_AXIS | POINTER_EVENT_AXIS_SOURCE |
+              POINTER_EVENT_AXIS_STOP | POINTER_EVENT_AXIS_DISCRETE;
+
+  return filter;
+}
+
+static void __track_button(glps_InputState *input, uint32_t button,
+                           bool pressed)
+{
+  switch (button)
+  {
+  case BTN_LEFT:
+    glps_input_state_button(input, GLPS_MOUSE_BUTTON_LEFT, pressed);
+    break;
+  case BTN_RIGHT:
+    glps_input_state_button(input, GLPS_MOUSE_BUTTON_RIGHT, pressed);
+    break;
+  case BTN_MIDDLE:
+    glps_input_state_button(input, GLPS_MOUSE_BUTTON_MIDDLE, pressed);
+    break;
+  case BTN_SIDE:
+  case BTN_BACK:
+    glps_input_state_button(input, GLPS_MOUSE_BUTTON_BACK, pressed);
+    break;
+  case BTN_EXTRA:
+  case BTN_FORWARD:
+    glps_input_state_button(input, GLPS_MOUSE_BUTTON_FORWARD, pressed);
+    break;
+  default:
+    break;
+  }
+}
+
+/* Folds a pointer frame into the input state of the window under it. */
+static void __track_pointer_frame(glps_WindowManager *wm,
+                                  const struct pointer_event *event)
+{
+  glps_InputState *input =
+      __input_state(wm, wm->wayland_ctx->mouse_window_id);
+  if (input == NULL)
+    return;
+
+  if (event->event_mask & POINTER_EVENT_ENTER)
+    input->pointer_inside = true;
+  if (event->event_mask & POINTER_EVENT_LEAVE)
+    input->pointer_inside = false;
+
+  if (event->event_mask & (POINTER_EVENT_ENTER | POINTER_EVENT_MOTION))
+  {
+    glps_input_state_motion(input, wl_fixed_to_double(event->surface_x),
+                            wl_fixed_to_double(event->surface_y));
+  }
+
+  if (event->event_mask & POINTER_EVENT_BUTTON)
+  {
+    __track_button(input, event->button,
+                   event->state == WL_POINTER_BUTTON_STATE_PRESSED);
+  }
+
+  if (event->event_mask & POINTER_EVENT_AXIS)
+  {
+    if (event->axes[WL_POINTER_AXIS_VERTICAL_SCROLL].valid)
+      glps_input_state_scroll(
+          input, GLPS_SCROLL_V_AXIS,
+          wl_fixed_to_double(
+              event->axes[WL_POINTER_AXIS_VERTICAL_SCROLL].value));
+    if (event->axes[WL_POINTER_AXIS_HORIZONTAL_SCROLL].valid)
+      glps_input_state_scroll(
+          input, GLPS_SCROLL_H_AXIS,
+          wl_fixed_to_double(
+              event->axes[WL_POINTER_AXIS_HORIZONTAL_SCROLL].value));
+  }
+}
+
 void wl_pointer_frame(void *data, struct wl_pointer *wl_pointer)
 {
   glps_WindowManager *context = (glps_WindowManager *)data;
@@ -250,6 +782,21 @@ void wl_pointer_frame(void *data, struct wl_pointer *wl_pointer)
     LOG_ERROR("Couldn't fetch wayland context.");
     return;
   }
+
+  // Drop the classes the window under the pointer did not subscribe to.
+  size_t mouse_window_id = wayland_context->mouse_window_id;
+  event->event_mask &=
+      __wants_events(context, mouse_window_id, GLPS_EVENT_ALL)
+          ? __pointer_event_filter(context->windows[mouse_window_id]->event_mask)
+          : 0;
+  if (event->event_mask == 0)
+  {
+    memset(event, 0, sizeof(*event));
+    return;
+  }
+
+  __track_pointer_frame(context, event);
+
   if (event->event_mask & POINTER_EVENT_ENTER)
   {
     // Mouse enter callback
@@ -350,6 +897,17 @@ void wl_pointer_frame(void *data, struct wl_pointer *wl_pointer)
     }
   }
   memset(event, 0, sizeof(*event));
+
+  glps_wl_window_request_redraw(context, wayland_context->mouse_window_id);
+}
+
+/* Pointer events reach callbacks from the frame event, so that is where an
+ * input span runs from the event to its callbacks returning. */
+static void __traced_pointer_frame(void *data, struct wl_pointer *wl_pointer)
+{
+  uint64_t span = GLPS_TRACE_BEGIN();
+  wl_pointer_frame(data, wl_pointer);
+  GLPS_TRACE_END("pointer_input", span);
 }
 
 struct wl_pointer_listener wl_pointer_listener = {
@@ -358,7 +916,7 @@ struct wl_pointer_listener wl_pointer_listener = {
     .motion = wl_pointer_motion,
     .button = wl_pointer_button,
     .axis = wl_pointer_axis,
-    .frame = wl_pointer_frame,
+    .frame = __traced_pointer_frame,
     .axis_source = wl_pointer_axis_source,
     .axis_stop = wl_pointer_axis_stop,
     .axis_discrete = wl_pointer_axis_discrete,
@@ -397,11 +955,6 @@ void wl_keyboard_enter(void *data, struct wl_keyboard *wl_keyboard,
     return;
 
   glps_WindowManager *wm = (glps_WindowManager *)data;
-  if (wm->callbacks.keyboard_enter_callback != NULL)
-  {
-    wm->callbacks.keyboard_enter_callback(context->keyboard_window_id,
-                                          wm->callbacks.keyboard_enter_data);
-  }
   ssize_t window_id = __get_window_id_from_surface(wm, surface);
 
   if (window_id < 0)
@@ -412,10 +965,21 @@ void wl_keyboard_enter(void *data, struct wl_keyboard *wl_keyboard,
   }
   context->keyboard_serial = serial;
   context->keyboard_window_id = (size_t)window_id;
+  // Focus is tracked for the scheduler even when the window ignores it.
+  glps_input_state_focus(&wm->windows[window_id]->input, true);
+
+  if (wm->callbacks.keyboard_enter_callback != NULL &&
+      __wants_events(wm, (size_t)window_id, GLPS_EVENT_FOCUS))
+  {
+    wm->callbacks.keyboard_enter_callback((size_t)window_id,
+                                          wm->callbacks.keyboard_enter_data);
+  }
 
   uint32_t *key;
   wl_array_for_each(key, keys)
   {
+    // Keys already held when focus arrives count as pressed.
+    glps_input_state_key(&wm->windows[window_id]->input, *key + 8, true);
     char buf[128];
     xkb_keysym_t sym = xkb_state_key_get_one_sym(context->xkb_state, *key + 8);
     xkb_keysym_get_name(sym, buf, sizeof(buf));
@@ -434,6 +998,22 @@ void wl_keyboard_key(void *data, struct wl_keyboard *wl_keyboard,
   char utf8[128] = "";
   char name[128] = "";
   uint32_t keycode = key + 8;
+
+  if (state == WL_KEYBOARD_KEY_STATE_PRESSED)
+  {
+    context->press_serial = serial;
+  }
+
+  if (!__wants_events((glps_WindowManager *)data, context->keyboard_window_id,
+                      GLPS_EVENT_KEYBOARD))
+    return;
+
+  glps_InputState *input =
+      __input_state((glps_WindowManager *)data, context->keyboard_window_id);
+  if (input != NULL)
+    glps_input_state_key(input, keycode,
+                         state == WL_KEYBOARD_KEY_STATE_PRESSED);
+
   xkb_keysym_t sym = xkb_state_key_get_one_sym(context->xkb_state, keycode);
   if (sym == XKB_KEY_NoSymbol)
     return;
@@ -457,13 +1037,22 @@ void wl_keyboard_key(void *data, struct wl_keyboard *wl_keyboard,
         state == WL_KEYBOARD_KEY_STATE_PRESSED ? true : false,
         (utf8[0] != '\0' ? utf8 : name), keycode, wm->callbacks.keyboard_data);
   }
+
+  glps_wl_window_request_redraw(wm, context->keyboard_window_id);
 }
 
 void wl_keyboard_leave(void *data, struct wl_keyboard *wl_keyboard,
                        uint32_t serial, struct wl_surface *surface)
 {
   glps_WindowManager *wm = (glps_WindowManager *)data;
-  if (wm->callbacks.keyboard_leave_callback != NULL)
+  glps_InputState *input =
+      __input_state(wm, wm->wayland_ctx->keyboard_window_id);
+  if (input != NULL)
+    glps_input_state_focus(input, false);
+
+  if (wm->callbacks.keyboard_leave_callback != NULL &&
+      __wants_events(wm, wm->wayland_ctx->keyboard_window_id,
+                     GLPS_EVENT_FOCUS))
   {
     wm->callbacks.keyboard_leave_callback(wm->wayland_ctx->keyboard_window_id,
                                           wm->callbacks.keyboard_leave_data);
@@ -484,11 +1073,37 @@ void wl_keyboard_modifiers(void *data, struct wl_keyboard *wl_keyboard,
 void wl_keyboard_repeat_info(void *data, struct wl_keyboard *wl_keyboard,
                              int32_t rate, int32_t delay) {}
 
+static void __traced_keyboard_enter(void *data, struct wl_keyboard *wl_keyboard,
+                                    uint32_t serial, struct wl_surface *surface,
+                                    struct wl_array *keys)
+{
+  uint64_t span = GLPS_TRACE_BEGIN();
+  wl_keyboard_enter(data, wl_keyboard, serial, surface, keys);
+  GLPS_TRACE_END("focus_input", span);
+}
+
+static void __traced_keyboard_leave(void *data, struct wl_keyboard *wl_keyboard,
+                                    uint32_t serial, struct wl_surface *surface)
+{
+  uint64_t span = GLPS_TRACE_BEGIN();
+  wl_keyboard_leave(data, wl_keyboard, serial, surface);
+  GLPS_TRACE_END("focus_input", span);
+}
+
+static void __traced_keyboard_key(void *data, struct wl_keyboard *wl_keyboard,
+                                  uint32_t serial, uint32_t time, uint32_t key,
+                                  uint32_t state)
+{
+  uint64_t span = GLPS_TRACE_BEGIN();
+  wl_keyboard_key(data, wl_keyboard, serial, time, key, state);
+  GLPS_TRACE_END("key_input", span);
+}
+
 struct wl_keyboard_listener wl_keyboard_listener = {
     .keymap = wl_keyboard_keymap,
-    .enter = wl_keyboard_enter,
-    .leave = wl_keyboard_leave,
-    .key = wl_keyboard_key,
+    .enter = __traced_keyboard_enter,
+    .leave = __traced_keyboard_leave,
+    .key = __traced_keyboard_key,
     .modifiers = wl_keyboard_modifiers,
     .repeat_info = wl_keyboard_repeat_info,
 };
@@ -533,6 +1148,10 @@ void wl_touch_down(void *data, struct wl_touch *wl_touch, uint32_t serial,
     return;
 
   glps_WindowManager *wm = (glps_WindowManager *)data;
+  if (wm->wayland_ctx)
+  {
+    wm->wayland_ctx->press_serial = serial;
+  }
 
   ssize_t window_id = __get_window_id_from_surface(wm, surface);
   if (window_id < 0)
@@ -655,6 +1274,16 @@ void wl_touch_frame(void *data, struct wl_touch *wl_touch)
 
   struct touch_event *touch = &wm->touch_event;
   const size_t nmemb = sizeof(touch->points) / sizeof(struct touch_point);
+
+  if (!__wants_events(wm, touch->window_id, GLPS_EVENT_TOUCH))
+  {
+    for (size_t i = 0; i < nmemb; ++i)
+    {
+      touch->points[i].valid = false;
+    }
+    return;
+  }
+
   fprintf(stderr, "touch event @ %d:\n", touch->time);
 
   for (size_t i = 0; i < nmemb; ++i)
@@ -681,68 +1310,107 @@ void wl_touch_frame(void *data, struct wl_touch *wl_touch)
     }
     point->valid = false;
   }
+
+  glps_wl_window_request_redraw(wm, touch->window_id);
+}
+
+/* Touch points reach callbacks from the frame event. */
+static void __traced_touch_frame(void *data, struct wl_touch *wl_touch)
+{
+  uint64_t span = GLPS_TRACE_BEGIN();
+  wl_touch_frame(data, wl_touch);
+  GLPS_TRACE_END("touch_input", span);
 }
 
 struct wl_touch_listener wl_touch_listener = {
     .down = wl_touch_down,
     .up = wl_touch_up,
     .motion = wl_touch_motion,
-    .frame = wl_touch_frame,
+    .frame = __traced_touch_frame,
     .cancel = wl_touch_cancel,
     .shape = wl_touch_shape,
     .orientation = wl_touch_orientation,
 };
 
-void wl_seat_capabilities(void *data, struct wl_seat *wl_seat,
-                          uint32_t capabilities)
+/* Event classes any window subscribed to; everything until a window exists. */
+static unsigned int __subscribed_events(glps_WindowManager *wm)
 {
+  if (wm->window_count == 0)
+    return GLPS_EVENT_ALL;
 
-  glps_WindowManager *context = (glps_WindowManager *)data;
-  bool have_pointer = capabilities & WL_SEAT_CAPABILITY_POINTER;
-  if (have_pointer && context->wayland_ctx->wl_pointer == NULL)
+  unsigned int mask = 0;
+  for (size_t i = 0; i < wm->window_count; ++i)
   {
-    context->wayland_ctx->wl_pointer =
-        wl_seat_get_pointer(context->wayland_ctx->wl_seat);
-    wl_pointer_add_listener(context->wayland_ctx->wl_pointer,
-                            &wl_pointer_listener, data);
+    if (wm->windows[i] != NULL)
+      mask |= wm->windows[i]->event_mask;
   }
-  else if (!have_pointer && context->wayland_ctx->wl_pointer != NULL)
+  return mask;
+}
+
+/* Gets the seat devices some window listens to and releases the others, so
+ * unused input never reaches the client. */
+static void __update_seat_devices(glps_WindowManager *wm)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+  uint32_t capabilities = ctx->seat_capabilities;
+  unsigned int subscribed = __subscribed_events(wm);
+
+  bool have_pointer =
+      (capabilities & WL_SEAT_CAPABILITY_POINTER) &&
+      (subscribed & (GLPS_EVENT_POINTER_MOTION | GLPS_EVENT_POINTER_BUTTON |
+                     GLPS_EVENT_POINTER_SCROLL | GLPS_EVENT_POINTER_CROSSING));
+  if (have_pointer && ctx->wl_pointer == NULL)
   {
-    wl_pointer_release(context->wayland_ctx->wl_pointer);
-    context->wayland_ctx->wl_pointer = NULL;
+    ctx->wl_pointer = wl_seat_get_pointer(ctx->wl_seat);
+    wl_pointer_add_listener(ctx->wl_pointer, &wl_pointer_listener, wm);
+  }
+  else if (!have_pointer && ctx->wl_pointer != NULL)
+  {
+    wl_pointer_release(ctx->wl_pointer);
+    ctx->wl_pointer = NULL;
+    ctx->pointer_enter_serial = 0;
+    __stop_cursor_animation(ctx);
   }
 
-  bool have_keyboard = capabilities & WL_SEAT_CAPABILITY_KEYBOARD;
+  bool have_keyboard =
+      (capabilities & WL_SEAT_CAPABILITY_KEYBOARD) &&
+      (subscribed & (GLPS_EVENT_KEYBOARD | GLPS_EVENT_FOCUS));
 
-  if (have_keyboard && context->wayland_ctx->wl_keyboard == NULL)
+  if (have_keyboard && ctx->wl_keyboard == NULL)
   {
-    context->wayland_ctx->wl_keyboard =
-        wl_seat_get_keyboard(context->wayland_ctx->wl_seat);
-    wl_keyboard_add_listener(context->wayland_ctx->wl_keyboard,
-                             &wl_keyboard_listener, data);
+    ctx->wl_keyboard = wl_seat_get_keyboard(ctx->wl_seat);
+    wl_keyboard_add_listener(ctx->wl_keyboard, &wl_keyboard_listener, wm);
   }
-  else if (!have_keyboard && context->wayland_ctx->wl_keyboard != NULL)
+  else if (!have_keyboard && ctx->wl_keyboard != NULL)
   {
-    wl_keyboard_release(context->wayland_ctx->wl_keyboard);
-    context->wayland_ctx->wl_keyboard = NULL;
+    wl_keyboard_release(ctx->wl_keyboard);
+    ctx->wl_keyboard = NULL;
   }
 
-  bool have_touch = capabilities & WL_SEAT_CAPABILITY_TOUCH;
+  bool have_touch = (capabilities & WL_SEAT_CAPABILITY_TOUCH) &&
+                    (subscribed & GLPS_EVENT_TOUCH);
 
-  if (have_touch && context->wayland_ctx->wl_touch == NULL)
+  if (have_touch && ctx->wl_touch == NULL)
   {
-    context->wayland_ctx->wl_touch =
-        wl_seat_get_touch(context->wayland_ctx->wl_seat);
-    wl_touch_add_listener(context->wayland_ctx->wl_touch, &wl_touch_listener,
-                          data);
+    ctx->wl_touch = wl_seat_get_touch(ctx->wl_seat);
+    wl_touch_add_listener(ctx->wl_touch, &wl_touch_listener, wm);
   }
-  else if (!have_touch && context->wayland_ctx->wl_touch != NULL)
+  else if (!have_touch && ctx->wl_touch != NULL)
   {
-    wl_touch_release(context->wayland_ctx->wl_touch);
-    context->wayland_ctx->wl_touch = NULL;
+    wl_touch_release(ctx->wl_touch);
+    ctx->wl_touch = NULL;
   }
 }
 
+void wl_seat_capabilities(void *data, struct wl_seat *wl_seat,
+                          uint32_t capabilities)
+{
+
+  glps_WindowManager *context = (glps_WindowManager *)data;
+  context->wayland_ctx->seat_capabilities = capabilities;
+  __update_seat_devices(context);
+}
+
 void wl_seat_name(void *data, struct wl_seat *wl_seat, const char *name) {}
 
 struct wl_seat_listener wl_seat_listener = {
@@ -779,10 +1447,12 @@ void data_source_handle_send(void *data, struct wl_data_source *source,
 
   if (strcmp(mime_type, wm->clipboard.mime_type) == 0)
   {
+    uint64_t trace_start = GLPS_TRACE_BEGIN();
     if (write(fd, wm->clipboard.buff, strlen(wm->clipboard.buff)) < 0)
     {
       LOG_ERROR("Error writing data to clipboard pipe.");
     }
+    GLPS_TRACE_END("clipboard_write", trace_start);
   }
   else
   {
@@ -1028,6 +1698,7 @@ void data_device_handle_selection(void *data,
     return;
   }
 
+  uint64_t trace_start = GLPS_TRACE_BEGIN();
   wl_display_roundtrip(context->wl_display);
   char buf[1024];
   size_t buff_size = sizeof(wm->clipboard.buff) - 1;
@@ -1047,6 +1718,8 @@ void data_device_handle_selection(void *data,
     }
   }
 
+  GLPS_TRACE_END("clipboard_read", trace_start);
+
   if (n < 0)
   {
     LOG_ERROR("Error reading clipboard data.");
@@ -1112,6 +1785,349 @@ struct wl_data_device_listener data_device_listener = {
 
 };
 
+/* wl_output v4 adds the connector name; older headers stop at v2, which still
+ * sends scale and done. */
+#ifdef WL_OUTPUT_NAME_SINCE_VERSION
+#define GLPS_WL_OUTPUT_VERSION WL_OUTPUT_NAME_SINCE_VERSION
+#else
+#define GLPS_WL_OUTPUT_VERSION 2
+#endif
+
+static glps_WaylandOutput *__find_output(glps_WaylandContext *ctx,
+                                         struct wl_output *wl_output)
+{
+  for (size_t i = 0; i < ctx->output_count; ++i)
+  {
+    if (ctx->outputs[i].wl_output == wl_output)
+      return &ctx->outputs[i];
+  }
+  return NULL;
+}
+
+static glps_WaylandOutput *__find_xdg_output(glps_WaylandContext *ctx,
+                                             struct zxdg_output_v1 *xdg_output)
+{
+  for (size_t i = 0; i < ctx->output_count; ++i)
+  {
+    if (ctx->outputs[i].xdg_output == xdg_output)
+      return &ctx->outputs[i];
+  }
+  return NULL;
+}
+
+/* Makes the accumulated state of an output visible to queries. */
+static void __publish_output(glps_WaylandOutput *output)
+{
+  glps_Output *pending = &output->pending;
+
+  if (pending->scale <= 0.0)
+    pending->scale = 1.0;
+
+  // Without xdg_output the logical size follows from the integer scale.
+  if (output->xdg_output == NULL)
+  {
+    pending->logical_width = (int)(pending->width / pending->scale);
+    pending->logical_height = (int)(pending->height / pending->scale);
+  }
+
+  output->info = *pending;
+}
+
+static void wl_output_geometry(void *data, struct wl_output *wl_output,
+                               int32_t x, int32_t y, int32_t physical_width,
+                               int32_t physical_height, int32_t subpixel,
+                               const char *make, const char *model,
+                               int32_t transform)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  glps_WaylandOutput *output = __find_output(wm->wayland_ctx, wl_output);
+  if (output == NULL || output->xdg_output != NULL)
+    return;
+
+  output->pending.x = x;
+  output->pending.y = y;
+}
+
+static void wl_output_mode(void *data, struct wl_output *wl_output,
+                           uint32_t flags, int32_t width, int32_t height,
+                           int32_t refresh)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  glps_WaylandOutput *output = __find_output(wm->wayland_ctx, wl_output);
+  if (output == NULL || !(flags & WL_OUTPUT_MODE_CURRENT))
+    return;
+
+  output->pending.width = width;
+  output->pending.height = height;
+  // The refresh rate is sent in mHz, 0 when it is not meaningful.
+  output->pending.refresh_hz =
+      refresh > 0 ? refresh / 1000.0 : GLPS_FALLBACK_REFRESH_HZ;
+}
+
+static void wl_output_done(void *data, struct wl_output *wl_output)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  glps_WaylandOutput *output = __find_output(wm->wayland_ctx, wl_output);
+  if (output != NULL)
+    __publish_output(output);
+}
+
+static void wl_output_scale(void *data, struct wl_output *wl_output,
+                            int32_t factor)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  glps_WaylandOutput *output = __find_output(wm->wayland_ctx, wl_output);
+  if (output != NULL)
+    output->pending.scale = factor;
+}
+
+#ifdef WL_OUTPUT_NAME_SINCE_VERSION
+static void wl_output_name(void *data, struct wl_output *wl_output,
+                           const char *name)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  glps_WaylandOutput *output = __find_output(wm->wayland_ctx, wl_output);
+  if (output != NULL)
+    snprintf(output->pending.name, sizeof(output->pending.name), "%s", name);
+}
+
+static void wl_output_description(void *data, struct wl_output *wl_output,
+                                  const char *description)
+{
+}
+#endif
+
+struct wl_output_listener wl_output_listener = {
+    .geometry = wl_output_geometry,
+    .mode = wl_output_mode,
+    .done = wl_output_done,
+    .scale = wl_output_scale,
+#ifdef WL_OUTPUT_NAME_SINCE_VERSION
+    .name = wl_output_name,
+    .description = wl_output_description,
+#endif
+};
+
+static void xdg_output_logical_position(void *data,
+                                        struct zxdg_output_v1 *xdg_output,
+                                        int32_t x, int32_t y)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  glps_WaylandOutput *output = __find_xdg_output(wm->wayland_ctx, xdg_output);
+  if (output == NULL)
+    return;
+
+  output->pending.x = x;
+  output->pending.y = y;
+}
+
+static void xdg_output_logical_size(void *data,
+                                    struct zxdg_output_v1 *xdg_output,
+                                    int32_t width, int32_t height)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  glps_WaylandOutput *output = __find_xdg_output(wm->wayland_ctx, xdg_output);
+  if (output == NULL)
+    return;
+
+  output->pending.logical_width = width;
+  output->pending.logical_height = height;
+}
+
+static void xdg_output_done(void *data, struct zxdg_output_v1 *xdg_output)
+{
+  // Only sent before v3; later versions batch into wl_output.done.
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  glps_WaylandOutput *output = __find_xdg_output(wm->wayland_ctx, xdg_output);
+  if (output != NULL)
+    __publish_output(output);
+}
+
+static void xdg_output_name(void *data, struct zxdg_output_v1 *xdg_output,
+                            const char *name)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  glps_WaylandOutput *output = __find_xdg_output(wm->wayland_ctx, xdg_output);
+  if (output != NULL && output->pending.name[0] == '\0')
+    snprintf(output->pending.name, sizeof(output->pending.name), "%s", name);
+}
+
+static void xdg_output_description(void *data,
+                                   struct zxdg_output_v1 *xdg_output,
+                                   const char *description)
+{
+}
+
+struct zxdg_output_v1_listener xdg_output_listener = {
+    .logical_position = xdg_output_logical_position,
+    .logical_size = xdg_output_logical_size,
+    .done = xdg_output_done,
+    .name = xdg_output_name,
+    .description = xdg_output_description,
+};
+
+static void __attach_xdg_output(glps_WindowManager *wm,
+                                glps_WaylandOutput *output)
+{
+  if (wm->wayland_ctx->xdg_output_manager == NULL || output->xdg_output != NULL)
+    return;
+
+  output->xdg_output = zxdg_output_manager_v1_get_xdg_output(
+      wm->wayland_ctx->xdg_output_manager, output->wl_output);
+  zxdg_output_v1_add_listener(output->xdg_output, &xdg_output_listener, wm);
+}
+
+static void __add_output(glps_WindowManager *wm, struct wl_registry *registry,
+                         uint32_t id, uint32_t version)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+  if (ctx->output_count >= GLPS_MAX_OUTPUTS)
+  {
+    LOG_WARNING("Too many outputs, ignoring wl_output %u.", id);
+    return;
+  }
+
+  glps_WaylandOutput *output = &ctx->outputs[ctx->output_count];
+  *output = (glps_WaylandOutput){0};
+  output->wl_output = wl_registry_bind(
+      registry, id, &wl_output_interface,
+      version < GLPS_WL_OUTPUT_VERSION ? version : GLPS_WL_OUTPUT_VERSION);
+  if (output->wl_output == NULL)
+  {
+    LOG_ERROR("Failed to bind wl_output.");
+    return;
+  }
+
+  output->pending.id = id;
+  output->pending.scale = 1.0;
+  output->pending.refresh_hz = GLPS_FALLBACK_REFRESH_HZ;
+  ctx->output_count++;
+
+  wl_output_add_listener(output->wl_output, &wl_output_listener, wm);
+  __attach_xdg_output(wm, output);
+}
+
+static void __destroy_output(glps_WaylandOutput *output)
+{
+  if (output->xdg_output != NULL)
+  {
+    zxdg_output_v1_destroy(output->xdg_output);
+    output->xdg_output = NULL;
+  }
+
+  if (output->wl_output != NULL)
+  {
+#ifdef WL_OUTPUT_RELEASE_SINCE_VERSION
+    if (wl_output_get_version(output->wl_output) >=
+        WL_OUTPUT_RELEASE_SINCE_VERSION)
+      wl_output_release(output->wl_output);
+    else
+#endif
+      wl_output_destroy(output->wl_output);
+    output->wl_output = NULL;
+  }
+}
+
+static void __remove_output(glps_WindowManager *wm, uint32_t id)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+
+  for (size_t i = 0; i < ctx->output_count; ++i)
+  {
+    if (ctx->outputs[i].pending.id != id)
+      continue;
+
+    __destroy_output(&ctx->outputs[i]);
+    memmove(&ctx->outputs[i], &ctx->outputs[i + 1],
+            (ctx->output_count - i - 1) * sizeof(glps_WaylandOutput));
+    ctx->output_count--;
+
+    for (size_t w = 0; w < wm->window_count; ++w)
+    {
+      if (wm->windows[w] != NULL && wm->windows[w]->output_id == id)
+        wm->windows[w]->output_id = 0;
+    }
+    return;
+  }
+}
+
+static void wl_surface_handle_enter(void *data, struct wl_surface *wl_surface,
+                                    struct wl_output *wl_output)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  ssize_t window_id = __get_window_id_from_surface(wm, wl_surface);
+  glps_WaylandOutput *output = __find_output(wm->wayland_ctx, wl_output);
+  if (window_id < 0 || output == NULL)
+    return;
+
+  wm->windows[window_id]->output_id = output->pending.id;
+}
+
+static void wl_surface_handle_leave(void *data, struct wl_surface *wl_surface,
+                                    struct wl_output *wl_output)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  ssize_t window_id = __get_window_id_from_surface(wm, wl_surface);
+  glps_WaylandOutput *output = __find_output(wm->wayland_ctx, wl_output);
+  if (window_id < 0 || output == NULL)
+    return;
+
+  if (wm->windows[window_id]->output_id == output->pending.id)
+    wm->windows[window_id]->output_id = 0;
+}
+
+struct wl_surface_listener wl_surface_listener = {
+    .enter = wl_surface_handle_enter,
+    .leave = wl_surface_handle_leave,
+};
+
+size_t glps_wl_get_outputs(glps_WindowManager *wm, glps_Output *outputs,
+                           size_t max_outputs)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+  size_t count = 0;
+
+  for (size_t i = 0; i < ctx->output_count; ++i)
+  {
+    // Outputs are listed once their first done event arrived.
+    if (ctx->outputs[i].info.id == 0)
+      continue;
+    if (outputs != NULL && count < max_outputs)
+      outputs[count] = ctx->outputs[i].info;
+    count++;
+  }
+
+  return count;
+}
+
+bool glps_wl_window_get_output(glps_WindowManager *wm, size_t window_id,
+                               glps_Output *output)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+  uint32_t output_id = wm->windows[window_id]->output_id;
+  glps_WaylandOutput *fallback = NULL;
+
+  for (size_t i = 0; i < ctx->output_count; ++i)
+  {
+    if (ctx->outputs[i].info.id == 0)
+      continue;
+    if (ctx->outputs[i].info.id == output_id)
+    {
+      *output = ctx->outputs[i].info;
+      return true;
+    }
+    if (fallback == NULL)
+      fallback = &ctx->outputs[i];
+  }
+
+  // Surfaces that entered no output yet are assumed on the first one.
+  if (fallback == NULL)
+    return false;
+
+  *output = fallback->info;
+  return true;
+}
+
 void handle_global(void *data, struct wl_registry *registry, uint32_t id,
                    const char *interface, uint32_t version)
 {
@@ -1123,8 +2139,9 @@ void handle_global(void *data, struct wl_registry *registry, uint32_t id,
 
   if (strcmp(interface, "wl_compositor") == 0)
   {
-    s->wl_compositor =
-        wl_registry_bind(registry, id, &wl_compositor_interface, 1);
+    s->compositor_version = version < 3 ? version : 3;
+    s->wl_compositor = wl_registry_bind(registry, id, &wl_compositor_interface,
+                                        s->compositor_version);
     if (!s->wl_compositor)
     {
       LOG_ERROR("Failed to bind wl_compositor.");
@@ -1134,9 +2151,20 @@ void handle_global(void *data, struct wl_registry *registry, uint32_t id,
       LOG_INFO("Successfully bound wl_compositor.");
     }
   }
+  else if (strcmp(interface, wl_subcompositor_interface.name) == 0)
+  {
+    s->subcompositor =
+        wl_registry_bind(registry, id, &wl_subcompositor_interface, 1);
+    if (!s->subcompositor)
+    {
+      LOG_ERROR("Failed to bind wl_subcompositor.");
+    }
+  }
   else if (strcmp(interface, "xdg_wm_base") == 0)
   {
-    s->xdg_wm_base = wl_registry_bind(registry, id, &xdg_wm_base_interface, 1);
+    s->xdg_wm_base = wl_registry_bind(
+        registry, id, &xdg_wm_base_interface,
+        version < GLPS_XDG_WM_BASE_VERSION ? version : GLPS_XDG_WM_BASE_VERSION);
     if (!s->xdg_wm_base)
     {
       LOG_ERROR("Failed to bind xdg_wm_base.");
@@ -1159,6 +2187,55 @@ void handle_global(void *data, struct wl_registry *registry, uint32_t id,
       LOG_INFO("Successfully bound zxdg_decoration_manager_v1.");
     }
   }
+  else if (strcmp(interface, wp_viewporter_interface.name) == 0)
+  {
+    s->viewporter =
+        wl_registry_bind(registry, id, &wp_viewporter_interface, 1);
+    if (!s->viewporter)
+    {
+      LOG_ERROR("Failed to bind wp_viewporter.");
+    }
+  }
+  else if (strcmp(interface, wp_fractional_scale_manager_v1_interface.name) ==
+           0)
+  {
+    s->fractional_scale_manager = wl_registry_bind(
+        registry, id, &wp_fractional_scale_manager_v1_interface, 1);
+    if (!s->fractional_scale_manager)
+    {
+      LOG_ERROR("Failed to bind wp_fractional_scale_manager_v1.");
+    }
+  }
+  else if (strcmp(interface, wl_shm_interface.name) == 0)
+  {
+    s->wl_shm = wl_registry_bind(registry, id, &wl_shm_interface, 1);
+    if (!s->wl_shm)
+    {
+      LOG_ERROR("Failed to bind wl_shm.");
+    }
+  }
+  else if (strcmp(interface, wl_output_interface.name) == 0)
+  {
+    __add_output(context, registry, id, version);
+  }
+  else if (strcmp(interface, zxdg_output_manager_v1_interface.name) == 0)
+  {
+    s->xdg_output_manager = wl_registry_bind(
+        registry, id, &zxdg_output_manager_v1_interface,
+        version < 3 ? version : 3);
+    if (!s->xdg_output_manager)
+    {
+      LOG_ERROR("Failed to bind zxdg_output_manager_v1.");
+    }
+    else
+    {
+      // Outputs announced before the manager still get logical geometry.
+      for (size_t i = 0; i < s->output_count; ++i)
+      {
+        __attach_xdg_output(context, &s->outputs[i]);
+      }
+    }
+  }
   else if (strcmp(interface, wl_seat_interface.name) == 0)
   {
     s->wl_seat = wl_registry_bind(registry, id, &wl_seat_interface, version);
@@ -1214,13 +2291,84 @@ void handle_global(void *data, struct wl_registry *registry, uint32_t id,
 }
 
 void handle_global_remove(void *data, struct wl_registry *registry,
-                          uint32_t name) {}
+                          uint32_t name)
+{
+  __remove_output((glps_WindowManager *)data, name);
+}
 
 struct wl_registry_listener registry_listener = {
     .global = handle_global,
     .global_remove = handle_global_remove,
 };
 
+static void __set_hidden(glps_WindowManager *wm, size_t window_id,
+                         unsigned int reason, bool hidden)
+{
+  glps_WaylandWindow *window = wm->windows[window_id];
+  bool was_visible = window->hidden_reasons == 0;
+
+  if (hidden)
+    window->hidden_reasons |= reason;
+  else
+    window->hidden_reasons &= ~reason;
+
+  bool visible = window->hidden_reasons == 0;
+  if (visible == was_visible)
+    return;
+
+  if (visible)
+  {
+    // Frames were skipped while hidden; commit to get callbacks going again.
+    window->redraw_requested = true;
+    window->last_frame_done_ns = glps_frame_stats_now_ns();
+    __arm_frame_callback(window);
+    wl_update(wm, window_id);
+  }
+
+  if (wm->callbacks.window_visibility_callback)
+  {
+    wm->callbacks.window_visibility_callback(
+        window_id, visible, wm->callbacks.window_visibility_data);
+  }
+}
+
+/* Applies the latest configure of a window once and acks it, so the ack
+ * lands in the same commit as the first buffer drawn at the new size. */
+static void __apply_pending_configure(glps_WindowManager *wm, size_t window_id)
+{
+  glps_WaylandWindow *window = wm->windows[window_id];
+  if (!window->configure_pending)
+    return;
+
+  window->configure_pending = false;
+  xdg_surface_ack_configure(window->xdg_surface, window->serial);
+
+  bool resized = false;
+  if (window->pending_width != 0 && window->pending_height != 0 &&
+      (window->pending_width != window->properties.width ||
+       window->pending_height != window->properties.height))
+  {
+    window->properties.width = window->pending_width;
+    window->properties.height = window->pending_height;
+    window->redraw_requested = true;
+    resized = true;
+  }
+
+  if (!resized)
+    return;
+
+  __apply_render_scale(window);
+
+  if (wm->callbacks.window_resize_callback)
+  {
+    uint64_t trace_start = GLPS_TRACE_BEGIN();
+    wm->callbacks.window_resize_callback(window_id, window->properties.width,
+                                         window->properties.height,
+                                         wm->callbacks.window_resize_data);
+    GLPS_TRACE_END("resize_callback", trace_start);
+  }
+}
+
 void frame_callback_done(void *data, struct wl_callback *callback,
                          uint32_t time)
 {
@@ -1237,21 +2385,57 @@ void frame_callback_done(void *data, struct wl_callback *callback,
   {
     wl_callback_destroy(callback);
   }
+  window->frame_callback = NULL;
+
+  glps_WindowManager *wm = args->wm;
+  size_t window_id = args->window_id;
+
+  window->last_frame_done_ns = glps_frame_stats_now_ns();
+  __set_hidden(wm, window_id, GLPS_HIDDEN_STALLED, false);
+  if (wm->windows[window_id] != window)
+    return;
 
-  if (window->wl_surface)
+  __apply_pending_configure(wm, window_id);
+  if (wm->windows[window_id] != window)
+    return;
+
+  // Nothing of a suspended window reaches the screen.
+  if (window->hidden_reasons != 0)
+    return;
+
+  // Windows rendered on demand go idle until the next redraw request.
+  if (window->render_mode == GLPS_RENDER_ON_DEMAND && !window->redraw_requested)
+    return;
+
+  window->redraw_requested = false;
+  __arm_frame_callback(window);
+
+  if (wm->callbacks.window_frame_update_callback)
   {
-    window->frame_callback = wl_surface_frame(window->wl_surface);
-    if (window->frame_callback)
-    {
-      wl_callback_add_listener(window->frame_callback, &frame_callback_listener,
-                               args);
-    }
+    // Drawn from the scheduler once the events of this dispatch are in.
+    glps_frame_scheduler_ready(wm, window_id);
   }
+}
+
+void glps_wl_window_run_frame(glps_WindowManager *wm, size_t window_id)
+{
+  glps_WaylandWindow *window = wm->windows[window_id];
+
+  // The window may have been hidden since its frame became ready.
+  if (window->hidden_reasons != 0 || window->awaiting_map ||
+      wm->callbacks.window_frame_update_callback == NULL)
+    return;
+
+  uint64_t trace_start = GLPS_TRACE_BEGIN();
+  glps_frame_stats_begin(&window->frame_stats);
+  wm->callbacks.window_frame_update_callback(
+      window_id, wm->callbacks.window_frame_update_data);
+  GLPS_TRACE_END("frame_callback", trace_start);
 
-  if (args->wm->callbacks.window_frame_update_callback)
+  // The callback may have destroyed the window.
+  if (wm->windows[window_id] == window)
   {
-    args->wm->callbacks.window_frame_update_callback(
-        args->window_id, args->wm->callbacks.window_frame_update_data);
+    glps_frame_stats_end(&window->frame_stats);
   }
 }
 
@@ -1270,22 +2454,37 @@ void handle_toplevel_configure(void *data, struct xdg_toplevel *toplevel,
 
   glps_WaylandWindow *window = wm->windows[window_id];
 
-  if (width != 0 && height != 0)
+  // Only recorded here; applied once per frame by __apply_pending_configure.
+  window->pending_width = width;
+  window->pending_height = height;
+
+  bool suspended = false;
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+  uint32_t *state;
+  wl_array_for_each(state, states)
   {
-    window->properties.height = height;
-    window->properties.width = width;
+    if (*state == XDG_TOPLEVEL_STATE_SUSPENDED)
+      suspended = true;
   }
+#endif
+  __set_hidden(wm, (size_t)window_id, GLPS_HIDDEN_SUSPENDED, suspended);
+}
 
-  wl_egl_window_resize(window->egl_window, width, height, 0, 0);
+#ifdef XDG_TOPLEVEL_CONFIGURE_BOUNDS_SINCE_VERSION
+static void handle_toplevel_configure_bounds(void *data,
+                                             struct xdg_toplevel *toplevel,
+                                             int32_t width, int32_t height)
+{
+}
+#endif
 
-  if (wm->callbacks.window_resize_callback)
-  {
-    wm->callbacks.window_resize_callback(window_id, window->properties.width,
-                                         window->properties.height,
-                                         wm->callbacks.window_resize_data);
-  }
-  wl_update(wm, window_id);
+#ifdef XDG_TOPLEVEL_WM_CAPABILITIES_SINCE_VERSION
+static void handle_toplevel_wm_capabilities(void *data,
+                                            struct xdg_toplevel *toplevel,
+                                            struct wl_array *capabilities)
+{
 }
+#endif
 
 void handle_toplevel_close(void *data, struct xdg_toplevel *toplevel)
 {
@@ -1313,6 +2512,12 @@ void handle_toplevel_close(void *data, struct xdg_toplevel *toplevel)
 struct xdg_toplevel_listener toplevel_listener = {
     .configure = handle_toplevel_configure,
     .close = handle_toplevel_close,
+#ifdef XDG_TOPLEVEL_CONFIGURE_BOUNDS_SINCE_VERSION
+    .configure_bounds = handle_toplevel_configure_bounds,
+#endif
+#ifdef XDG_TOPLEVEL_WM_CAPABILITIES_SINCE_VERSION
+    .wm_capabilities = handle_toplevel_wm_capabilities,
+#endif
 };
 
 void xdg_surface_configure(void *data, struct xdg_surface *xdg_surface,
@@ -1333,15 +2538,50 @@ void xdg_surface_configure(void *data, struct xdg_surface *xdg_surface,
     return;
   }
 
-  xdg_surface_ack_configure(xdg_surface, serial);
-
   ssize_t window_id = __get_window_id_from_xdg_surface(wm, xdg_surface);
   if (window_id < 0)
   {
+    // Initial configure of a window still being created: nothing is drawn
+    // yet, so ack right away.
+    xdg_surface_ack_configure(xdg_surface, serial);
     return;
   }
 
-  wm->windows[(size_t)window_id]->serial = serial;
+  glps_WaylandWindow *window = wm->windows[(size_t)window_id];
+
+  window->serial = serial;
+  window->configure_pending = true;
+
+  // Nothing is drawn before the initial configure of pooled windows and
+  // popups, so it is applied at once.
+  if (window->awaiting_map)
+  {
+    window->awaiting_map = false;
+    __apply_pending_configure(wm, (size_t)window_id);
+    if (wm->windows[(size_t)window_id] != window)
+      return;
+
+    // An unmapped surface may never see its frame callback, so the first
+    // frame is started here instead.
+    if (window->frame_callback != NULL)
+    {
+      wl_callback_destroy(window->frame_callback);
+      window->frame_callback = NULL;
+    }
+    window->redraw_requested = true;
+    frame_callback_done(window->frame_args, NULL, 0);
+    return;
+  }
+
+  // Without a frame callback nothing commits a new frame, so apply now.
+  if (wm->callbacks.window_frame_update_callback == NULL)
+  {
+    __apply_pending_configure(wm, (size_t)window_id);
+    if (wm->windows[(size_t)window_id] == window)
+    {
+      wl_update(wm, (size_t)window_id);
+    }
+  }
 }
 
 struct xdg_surface_listener xdg_surface_listener = {
@@ -1360,6 +2600,20 @@ static void _cleanup_wl(glps_WindowManager *wm)
   free(wm->windows);
   wm->windows = NULL;
 
+  if (wm->wayland_ctx != NULL)
+  {
+    while (wm->wayland_ctx->pool_count > 0)
+    {
+      __window_free(wm, wm->wayland_ctx->pool[--wm->wayland_ctx->pool_count]);
+    }
+  }
+
+  // The EGL display outlives its surfaces but not the connection.
+  if (wm->egl_ctx != NULL)
+  {
+    glps_egl_destroy(wm);
+  }
+
   if (wm->wayland_ctx != NULL)
   {
     if (wm->wayland_ctx->wl_seat != NULL)
@@ -1374,7 +2628,39 @@ static void _cleanup_wl(glps_WindowManager *wm)
     {
       zxdg_decoration_manager_v1_destroy(wm->wayland_ctx->decoration_manager);
     }
+    if (wm->wayland_ctx->viewporter != NULL)
+    {
+      wp_viewporter_destroy(wm->wayland_ctx->viewporter);
+      wm->wayland_ctx->viewporter = NULL;
+    }
+    if (wm->wayland_ctx->fractional_scale_manager != NULL)
+    {
+      wp_fractional_scale_manager_v1_destroy(
+          wm->wayland_ctx->fractional_scale_manager);
+      wm->wayland_ctx->fractional_scale_manager = NULL;
+    }
+    __destroy_cursors(wm->wayland_ctx);
+    if (wm->wayland_ctx->wl_shm != NULL)
+    {
+      wl_shm_destroy(wm->wayland_ctx->wl_shm);
+      wm->wayland_ctx->wl_shm = NULL;
+    }
+    for (size_t i = 0; i < wm->wayland_ctx->output_count; ++i)
+    {
+      __destroy_output(&wm->wayland_ctx->outputs[i]);
+    }
+    wm->wayland_ctx->output_count = 0;
+    if (wm->wayland_ctx->xdg_output_manager != NULL)
+    {
+      zxdg_output_manager_v1_destroy(wm->wayland_ctx->xdg_output_manager);
+      wm->wayland_ctx->xdg_output_manager = NULL;
+    }
 
+    if (wm->wayland_ctx->subcompositor != NULL)
+    {
+      wl_subcompositor_destroy(wm->wayland_ctx->subcompositor);
+      wm->wayland_ctx->subcompositor = NULL;
+    }
     if (wm->wayland_ctx->wl_compositor != NULL)
     {
       wl_compositor_destroy(wm->wayland_ctx->wl_compositor);
@@ -1443,15 +2729,18 @@ static void _cleanup_wl(glps_WindowManager *wm)
   }
 }
 
-ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
-                              int width, int height)
+/* Creates the surface and EGL objects of a window, without a role. Nothing
+ * is committed, so the window stays unmapped. */
+static glps_WaylandWindow *__window_build(glps_WindowManager *wm, int width,
+                                          int height)
 {
   glps_WaylandWindow *window = malloc(sizeof(glps_WaylandWindow));
   if (window == NULL)
   {
     LOG_ERROR("Wayland window allocation failed.");
-    return -1;
+    return NULL;
   }
+  *window = (glps_WaylandWindow){0};
 
   window->wl_surface =
       wl_compositor_create_surface(wm->wayland_ctx->wl_compositor);
@@ -1460,13 +2749,65 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
     LOG_ERROR("Failed to create wayland surface");
     exit(EXIT_FAILURE);
   }
+  wl_surface_add_listener(window->wl_surface, &wl_surface_listener, wm);
 
   window->properties.width = width;
   window->properties.height = height;
+  window->render_scale = 1.0;
+  window->preferred_scale = 1.0;
+  window->event_mask = GLPS_EVENT_ALL;
 
-  window->fps_start_time = (struct timespec){0};
-  window->fps_is_init = false;
+  glps_frame_stats_init(&window->frame_stats);
+  window->last_frame_done_ns = glps_frame_stats_now_ns();
+
+  if (wm->wayland_ctx->viewporter != NULL)
+  {
+    window->viewport =
+        wp_viewporter_get_viewport(wm->wayland_ctx->viewporter,
+                                   window->wl_surface);
+  }
+
+  if (wm->wayland_ctx->fractional_scale_manager != NULL)
+  {
+    window->fractional_scale =
+        wp_fractional_scale_manager_v1_get_fractional_scale(
+            wm->wayland_ctx->fractional_scale_manager, window->wl_surface);
+    wp_fractional_scale_v1_add_listener(window->fractional_scale,
+                                        &fractional_scale_listener, window);
+  }
+
+  window->egl_window = wl_egl_window_create(
+      window->wl_surface, window->properties.width, window->properties.height);
+  if (!window->egl_window)
+  {
+    LOG_ERROR("Failed to create EGL window");
+    exit(EXIT_FAILURE);
+  }
+  __apply_render_scale(window);
+
+  window->egl_surface =
+      eglCreateWindowSurface(wm->egl_ctx->dpy, wm->egl_ctx->conf,
+                             (NativeWindowType)window->egl_window, NULL);
+  if (window->egl_surface == EGL_NO_SURFACE)
+  {
+    LOG_ERROR("Failed to create EGL surface");
+    exit(EXIT_FAILURE);
+  }
 
+  frame_callback_args *frame_args =
+      (frame_callback_args *)malloc(sizeof(frame_callback_args));
+  frame_args->wm = wm;
+  window->frame_args = (void *)frame_args;
+
+  return window;
+}
+
+/* Gives a built window the xdg_toplevel role. */
+static void __window_make_toplevel(glps_WindowManager *wm,
+                                   glps_WaylandWindow *window,
+                                   const char *title)
+{
+  window->role = GLPS_WINDOW_TOPLEVEL;
   window->xdg_surface = xdg_wm_base_get_xdg_surface(
       wm->wayland_ctx->xdg_wm_base, window->wl_surface);
 
@@ -1491,11 +2832,11 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
   }
 
   xdg_toplevel_set_title(window->xdg_toplevel, title);
-  strcpy(window->properties.title, title);
+  snprintf(window->properties.title, sizeof(window->properties.title), "%s",
+           title);
   xdg_toplevel_add_listener(window->xdg_toplevel, &toplevel_listener, wm);
   if (wm->wayland_ctx->decoration_manager != NULL)
   {
-
     window->zxdg_toplevel_decoration =
         zxdg_decoration_manager_v1_get_toplevel_decoration(
             wm->wayland_ctx->decoration_manager, window->xdg_toplevel);
@@ -1503,48 +2844,400 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
         window->zxdg_toplevel_decoration,
         ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE);
   }
+}
+
+static ssize_t __get_window_id_from_xdg_popup(glps_WindowManager *wm,
+                                              struct xdg_popup *popup)
+{
+  for (size_t i = 0; i < wm->window_count; ++i)
+  {
+    if (wm->windows[i] != NULL && wm->windows[i]->xdg_popup == popup)
+      return i;
+  }
+
+  return -1;
+}
+
+static void xdg_popup_configure(void *data, struct xdg_popup *xdg_popup,
+                                int32_t x, int32_t y, int32_t width,
+                                int32_t height)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  ssize_t window_id = __get_window_id_from_xdg_popup(wm, xdg_popup);
+  if (window_id < 0)
+    return;
 
+  // Applied with the xdg_surface configure that follows.
+  wm->windows[window_id]->pending_width = width;
+  wm->windows[window_id]->pending_height = height;
+}
+
+static void xdg_popup_done(void *data, struct xdg_popup *xdg_popup)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  ssize_t window_id = __get_window_id_from_xdg_popup(wm, xdg_popup);
+  if (window_id < 0)
+    return;
+
+  // The compositor dismissed the popup; the application destroys it.
+  if (wm->callbacks.window_close_callback)
+  {
+    wm->callbacks.window_close_callback((size_t)window_id,
+                                        wm->callbacks.window_close_data);
+  }
+}
+
+#ifdef XDG_POPUP_REPOSITIONED_SINCE_VERSION
+static void xdg_popup_repositioned(void *data, struct xdg_popup *xdg_popup,
+                                   uint32_t token)
+{
+  // The new geometry arrives with the configure sent alongside.
+  (void)data;
+  (void)xdg_popup;
+  (void)token;
+}
+#endif
+
+struct xdg_popup_listener xdg_popup_listener = {
+    .configure = xdg_popup_configure,
+    .popup_done = xdg_popup_done,
+#ifdef XDG_POPUP_REPOSITIONED_SINCE_VERSION
+    .repositioned = xdg_popup_repositioned,
+#endif
+};
+
+/* Gives a built window the xdg_popup role, anchored at a point of its
+ * parent and flipped or slid by the compositor to stay on screen. */
+static void __window_make_popup(glps_WindowManager *wm,
+                                glps_WaylandWindow *window,
+                                glps_WaylandWindow *parent, int x, int y,
+                                bool grab)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+
+  window->role = GLPS_WINDOW_POPUP;
+  window->parent = parent;
+
+  struct xdg_positioner *positioner =
+      xdg_wm_base_create_positioner(ctx->xdg_wm_base);
+  xdg_positioner_set_size(positioner, window->properties.width,
+                          window->properties.height);
+  xdg_positioner_set_anchor_rect(positioner, x, y, 1, 1);
+  xdg_positioner_set_anchor(positioner, XDG_POSITIONER_ANCHOR_TOP_LEFT);
+  xdg_positioner_set_gravity(positioner, XDG_POSITIONER_GRAVITY_BOTTOM_RIGHT);
+  xdg_positioner_set_constraint_adjustment(
+      positioner, XDG_POSITIONER_CONSTRAINT_ADJUSTMENT_FLIP_X |
+                      XDG_POSITIONER_CONSTRAINT_ADJUSTMENT_FLIP_Y |
+                      XDG_POSITIONER_CONSTRAINT_ADJUSTMENT_SLIDE_X |
+                      XDG_POSITIONER_CONSTRAINT_ADJUSTMENT_SLIDE_Y);
+
+  window->xdg_surface =
+      xdg_wm_base_get_xdg_surface(ctx->xdg_wm_base, window->wl_surface);
+  xdg_surface_add_listener(window->xdg_surface, &xdg_surface_listener, wm);
+  window->xdg_popup = xdg_surface_get_popup(window->xdg_surface,
+                                            parent->xdg_surface, positioner);
+  xdg_positioner_destroy(positioner);
+  xdg_popup_add_listener(window->xdg_popup, &xdg_popup_listener, wm);
+
+  // A grab needs the serial of the press that opened the menu; enter and
+  // leave serials are refused.
+  if (grab && ctx->wl_seat != NULL && ctx->press_serial != 0)
+  {
+    xdg_popup_grab(window->xdg_popup, ctx->wl_seat, ctx->press_serial);
+  }
+}
+
+/* Gives a built window the wl_subsurface role. The subsurface is
+ * desynchronized so it can be redrawn without committing its parent. */
+static bool __window_make_subsurface(glps_WindowManager *wm,
+                                     glps_WaylandWindow *window,
+                                     glps_WaylandWindow *parent, int x, int y)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+
+  if (ctx->subcompositor == NULL)
+  {
+    LOG_ERROR("wl_subcompositor is unavailable, can't create subsurface.");
+    return false;
+  }
+
+  window->role = GLPS_WINDOW_SUBSURFACE;
+  window->parent = parent;
+  window->subsurface = wl_subcompositor_get_subsurface(
+      ctx->subcompositor, window->wl_surface, parent->wl_surface);
+  wl_subsurface_set_position(window->subsurface, x, y);
+  wl_subsurface_set_desync(window->subsurface);
+  return true;
+}
+
+/* Returns the first slot freed by a destroyed window, or the next unused
+ * one. The first slot is never reused, its window ends the program. */
+static ssize_t __free_slot(glps_WindowManager *wm)
+{
+  for (size_t i = 1; i < wm->window_count; ++i)
+  {
+    if (wm->windows[i] == NULL)
+      return (ssize_t)i;
+  }
+
+  if (wm->window_count >= MAX_WINDOWS)
+  {
+    LOG_ERROR("Maximum number of windows reached.");
+    return -1;
+  }
+  return (ssize_t)wm->window_count;
+}
+
+/* Puts a window in a slot from __free_slot() and requests its first frame
+ * callback. */
+static size_t __window_attach(glps_WindowManager *wm,
+                              glps_WaylandWindow *window, size_t window_id)
+{
+  wm->windows[window_id] = window;
+  ((frame_callback_args *)window->frame_args)->window_id = window_id;
+
+  window->frame_callback = wl_surface_frame(window->wl_surface);
+  wl_callback_add_listener(window->frame_callback, &frame_callback_listener,
+                           window->frame_args);
+
+  if (window_id == wm->window_count)
+  {
+    ++wm->window_count;
+  }
+
+  // A window listening to everything may need devices released earlier.
+  __update_seat_devices(wm);
+  return window_id;
+}
+
+/* Returns a released window to its state right after __window_build(). */
+static void __window_reset(glps_WaylandWindow *window)
+{
+  glps_frame_stats_init(&window->frame_stats);
+  window->last_frame_done_ns = glps_frame_stats_now_ns();
+  glps_gpu_timer_destroy(&window->gpu_timer);
+  window->dynamic_resolution = (glps_DynamicResolution){0};
+  window->schedule = (glps_FrameSchedule){0};
+  window->input = (glps_InputState){0};
+  window->configure_pending = false;
+  window->pending_width = 0;
+  window->pending_height = 0;
+  window->hidden_reasons = 0;
+  window->render_mode = GLPS_RENDER_CONTINUOUS;
+  window->redraw_requested = false;
+  window->render_scale = 1.0;
+  window->output_id = 0;
+  window->event_mask = GLPS_EVENT_ALL;
+  window->awaiting_map = false;
+}
+
+/* Maps a pooled window under a new title and size. The compositor answers
+ * the commit with an initial configure, so no roundtrip is needed. */
+static size_t __window_acquire(glps_WindowManager *wm, size_t window_id,
+                               const char *title, int width, int height)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+  glps_WaylandWindow *window = ctx->pool[--ctx->pool_count];
+
+  xdg_toplevel_set_title(window->xdg_toplevel, title);
+  snprintf(window->properties.title, sizeof(window->properties.title), "%s",
+           title);
+  window->properties.width = width;
+  window->properties.height = height;
+  __apply_render_scale(window);
+
+  window->awaiting_map = true;
+  __window_attach(wm, window, window_id);
   wl_surface_commit(window->wl_surface);
+  return window_id;
+}
 
-  wl_display_roundtrip(wm->wayland_ctx->wl_display);
+/* Unmaps a window and keeps it for reuse if the pool has room. */
+static bool __window_release(glps_WindowManager *wm, size_t window_id)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
 
-  window->egl_window = wl_egl_window_create(
-      window->wl_surface, window->properties.width, window->properties.height);
-  if (!window->egl_window)
+  glps_WaylandWindow *window = wm->windows[window_id];
+
+  // The first window's destruction ends the program, it is never pooled.
+  if (window_id == 0 || window->role != GLPS_WINDOW_TOPLEVEL ||
+      ctx->pool_count >= ctx->pool_capacity)
+    return false;
+
+  for (size_t i = 0; i < wm->window_count; ++i)
   {
-    LOG_ERROR("Failed to create EGL window");
-    exit(EXIT_FAILURE);
+    if (wm->windows[i] != NULL && wm->windows[i]->parent == window)
+    {
+      __window_destroy(wm, i);
+    }
+  }
+  if (window->frame_callback != NULL)
+  {
+    wl_callback_destroy(window->frame_callback);
+    window->frame_callback = NULL;
   }
 
-  window->egl_surface =
-      eglCreateWindowSurface(wm->egl_ctx->dpy, wm->egl_ctx->conf,
-                             (NativeWindowType)window->egl_window, NULL);
-  if (window->egl_surface == EGL_NO_SURFACE)
+  xdg_toplevel_set_min_size(window->xdg_toplevel, 0, 0);
+  xdg_toplevel_set_max_size(window->xdg_toplevel, 0, 0);
+  wl_surface_attach(window->wl_surface, NULL, 0, 0);
+  wl_surface_commit(window->wl_surface);
+
+  __window_reset(window);
+  ctx->pool[ctx->pool_count++] = window;
+  wm->windows[window_id] = NULL;
+  return true;
+}
+
+ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
+                              int width, int height)
+{
+  ssize_t window_id = __free_slot(wm);
+  if (window_id < 0)
   {
-    LOG_ERROR("Failed to create EGL surface");
-    exit(EXIT_FAILURE);
+    return -1;
   }
 
-  wm->windows[wm->window_count] = window;
+  if (wm->wayland_ctx->pool_count > 0)
+  {
+    return __window_acquire(wm, (size_t)window_id, title, width, height);
+  }
+
+  glps_WaylandWindow *window = __window_build(wm, width, height);
+  if (window == NULL)
+  {
+    return -1;
+  }
+  __window_make_toplevel(wm, window, title);
+
+  wl_surface_commit(window->wl_surface);
+
+  wl_display_roundtrip(wm->wayland_ctx->wl_display);
 
   if (wm->window_count == 0)
   {
+    wm->windows[0] = window;
     glps_egl_create_ctx(wm);
     glps_egl_make_ctx_current(wm, 0);
   }
 
-  // setup frame callback
-  frame_callback_args *frame_args =
-      (frame_callback_args *)malloc(sizeof(frame_callback_args));
-  window->frame_callback = wl_surface_frame(window->wl_surface);
-  frame_args->wm = wm;
-  frame_args->window_id = wm->window_count;
-  window->frame_args = (void *)frame_args;
+  return __window_attach(wm, window, (size_t)window_id);
+}
 
-  wl_callback_add_listener(window->frame_callback, &frame_callback_listener,
-                           frame_args);
+size_t glps_wl_window_pool_reserve(glps_WindowManager *wm, size_t count)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+
+  if (count > GLPS_MAX_POOLED_WINDOWS)
+  {
+    LOG_WARNING("Window pool limited to %d windows.", GLPS_MAX_POOLED_WINDOWS);
+    count = GLPS_MAX_POOLED_WINDOWS;
+  }
+
+  // Pooled windows share the context created with the first window.
+  if (wm->window_count == 0 && count > 0)
+  {
+    LOG_ERROR("Couldn't fill window pool. Create a window first.");
+    return 0;
+  }
+
+  ctx->pool_capacity = count;
+
+  while (ctx->pool_count > count)
+  {
+    __window_free(wm, ctx->pool[--ctx->pool_count]);
+  }
+
+  while (ctx->pool_count < count)
+  {
+    glps_WaylandWindow *window = __window_build(wm, 1, 1);
+    if (window == NULL)
+      break;
+    __window_make_toplevel(wm, window, "");
+    ctx->pool[ctx->pool_count++] = window;
+  }
+
+  return ctx->pool_count;
+}
+
+ssize_t glps_wl_popup_create(glps_WindowManager *wm, size_t parent_id, int x,
+                             int y, int width, int height, bool grab)
+{
+  glps_WaylandWindow *parent = wm->windows[parent_id];
+  if (parent->xdg_surface == NULL)
+  {
+    LOG_ERROR("Couldn't create popup. Parent %zu is a subsurface.", parent_id);
+    return -1;
+  }
+
+  ssize_t window_id = __free_slot(wm);
+  if (window_id < 0)
+  {
+    return -1;
+  }
+
+  glps_WaylandWindow *window = __window_build(wm, width, height);
+  if (window == NULL)
+  {
+    return -1;
+  }
+  __window_make_popup(wm, window, parent, x, y, grab);
 
-  return wm->window_count++;
+  // Nothing is drawn until the initial configure places the popup.
+  window->awaiting_map = true;
+  __window_attach(wm, window, (size_t)window_id);
+  wl_surface_commit(window->wl_surface);
+  return window_id;
+}
+
+ssize_t glps_wl_subsurface_create(glps_WindowManager *wm, size_t parent_id,
+                                  int x, int y, int width, int height)
+{
+  ssize_t window_id = __free_slot(wm);
+  if (window_id < 0)
+  {
+    return -1;
+  }
+
+  glps_WaylandWindow *window = __window_build(wm, width, height);
+  if (window == NULL)
+  {
+    return -1;
+  }
+
+  if (!__window_make_subsurface(wm, window, wm->windows[parent_id], x, y))
+  {
+    __window_free(wm, window);
+    return -1;
+  }
+
+  __window_attach(wm, window, (size_t)window_id);
+
+  // The position is parent state, applied by the parent's next commit.
+  glps_wl_window_request_redraw(wm, parent_id);
+  return window_id;
+}
+
+void glps_wl_subsurface_set_position(glps_WindowManager *wm, size_t window_id,
+                                     int x, int y)
+{
+  glps_WaylandWindow *window = wm->windows[window_id];
+
+  wl_subsurface_set_position(window->subsurface, x, y);
+  for (size_t i = 0; i < wm->window_count; ++i)
+  {
+    if (wm->windows[i] == window->parent)
+    {
+      glps_wl_window_request_redraw(wm, i);
+      break;
+    }
+  }
+}
+
+void glps_wl_window_set_event_mask(glps_WindowManager *wm, size_t window_id,
+                                   unsigned int mask)
+{
+  wm->windows[window_id]->event_mask = mask;
+  __update_seat_devices(wm);
 }
 
 void glps_wl_window_is_resizable(glps_WindowManager *wm, bool state, size_t window_id)
@@ -1564,19 +3257,260 @@ void glps_wl_window_is_resizable(glps_WindowManager *wm, bool state, size_t wind
     return;
   }
 
+  if (window->xdg_toplevel == NULL)
+  {
+    LOG_WARNING("Only toplevel windows have a resize hint.");
+    return;
+  }
+
   int window_width = window->properties.width;
   int window_height = window->properties.height;
   xdg_toplevel_set_min_size(window->xdg_toplevel, state ? 0 : window_width, state ? 0 : window_height);
   xdg_toplevel_set_max_size(window->xdg_toplevel, state ? INT32_MAX : window_width, state ? INT32_MAX : window_height);
 }
 
+/* Flags windows whose compositor stopped sending frame callbacks, e.g.
+ * because they are minimized or on another workspace. */
+static void __detect_stalled_windows(glps_WindowManager *wm)
+{
+  if (wm->callbacks.window_frame_update_callback == NULL)
+    return;
+
+  uint64_t now = glps_frame_stats_now_ns();
+  for (size_t i = 0; i < wm->window_count; ++i)
+  {
+    glps_WaylandWindow *window = wm->windows[i];
+    // Idle windows rendered on demand wait for no frame callback.
+    if (window == NULL || window->hidden_reasons != 0 ||
+        window->frame_callback == NULL)
+      continue;
+
+    if (now - window->last_frame_done_ns > GLPS_FRAME_STALL_NS)
+    {
+      __set_hidden(wm, i, GLPS_HIDDEN_STALLED, true);
+    }
+  }
+}
+
+/* The dispatch wait, cut short so a stall is flagged on time even when no
+ * event arrives to end the wait. */
+static int __wait_timeout_ms(glps_WindowManager *wm)
+{
+  int timeout_ms = wm->wait_timeout_ms;
+  if (wm->callbacks.window_frame_update_callback == NULL)
+    return timeout_ms;
+
+  uint64_t now = glps_frame_stats_now_ns();
+  for (size_t i = 0; i < wm->window_count; ++i)
+  {
+    glps_WaylandWindow *window = wm->windows[i];
+    if (window == NULL || window->hidden_reasons != 0 ||
+        window->frame_callback == NULL)
+      continue;
+
+    uint64_t stall_at = window->last_frame_done_ns + GLPS_FRAME_STALL_NS;
+    // One past the threshold, since a stall needs strictly more than it.
+    int stall_ms = glps_frame_stats_timeout_ms(
+        (stall_at > now ? stall_at - now : 0) + 1);
+    if (timeout_ms < 0 || stall_ms < timeout_ms)
+      timeout_ms = stall_ms;
+  }
+  return timeout_ms;
+}
+
+/* Reader thread: moves events from the socket into their queues and wakes
+ * the UI thread, which only ever dispatches what was already read. Reads are
+ * prepared on a private, always empty queue so pending UI events never make
+ * the reader spin. */
+static void *__reader_main(void *arg)
+{
+  glps_WindowManager *wm = arg;
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+  struct wl_display *display = ctx->wl_display;
+  int fd = wl_display_get_fd(display);
+
+  glps_trace_set_thread_name("glps-wayland-reader");
+
+  while (!glps_event_reader_should_stop(&ctx->reader))
+  {
+    while (wl_display_prepare_read_queue(display, ctx->reader_queue) != 0)
+    {
+      wl_display_dispatch_queue_pending(display, ctx->reader_queue);
+    }
+    wl_display_flush(display);
+
+    if (!glps_event_reader_wait(&ctx->reader, fd))
+    {
+      wl_display_cancel_read(display);
+      continue;
+    }
+
+    uint64_t span = GLPS_TRACE_BEGIN();
+    int result = wl_display_read_events(display);
+    GLPS_TRACE_END("wayland_read", span);
+
+    if (result == -1)
+    {
+      LOG_ERROR("Wayland event thread lost the connection.");
+      atomic_store(&ctx->reader.failed, true);
+      glps_event_loop_wake(&wm->event_loop);
+      break;
+    }
+    glps_event_loop_wake(&wm->event_loop);
+  }
+
+  return NULL;
+}
+
+bool glps_wl_set_event_thread(glps_WindowManager *wm, bool enabled)
+{
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+
+  if (enabled == ctx->reader.running)
+    return true;
+
+  if (!enabled)
+  {
+    glps_event_reader_stop(&ctx->reader);
+    wl_event_queue_destroy(ctx->reader_queue);
+    ctx->reader_queue = NULL;
+    return true;
+  }
+
+  ctx->reader_queue = wl_display_create_queue(ctx->wl_display);
+  if (ctx->reader_queue == NULL)
+  {
+    LOG_ERROR("Failed to create Wayland reader queue.");
+    return false;
+  }
+
+  if (!glps_event_reader_start(&ctx->reader, __reader_main, wm))
+  {
+    wl_event_queue_destroy(ctx->reader_queue);
+    ctx->reader_queue = NULL;
+    return false;
+  }
+
+  return true;
+}
+
+/* With the reader thread running the socket is never touched here: dispatch
+ * what it read, or sleep until it, a task or a watched descriptor wakes us. */
+static int __dispatch_read_events(glps_WindowManager *wm)
+{
+  struct wl_display *display = wm->wayland_ctx->wl_display;
+
+  if (atomic_load(&wm->wayland_ctx->reader.failed))
+    return -1;
+
+  int count = wl_display_dispatch_pending(display);
+  if (count != 0)
+    return count;
+
+  wl_display_flush(display);
+  if (glps_event_loop_poll(&wm->event_loop, -1, __wait_timeout_ms(wm)) == -1 &&
+      errno != EINTR)
+    return -1;
+
+  return wl_display_dispatch_pending(display);
+}
+
+/* Blocks like wl_display_dispatch(), but also returns when a task is
+ * posted or a watched descriptor becomes ready. */
+static int __dispatch_display(glps_WindowManager *wm)
+{
+  struct wl_display *display = wm->wayland_ctx->wl_display;
+
+  if (wm->wayland_ctx->reader.running)
+    return __dispatch_read_events(wm);
+
+  int dispatched = 0;
+  while (wl_display_prepare_read(display) != 0)
+  {
+    int count = wl_display_dispatch_pending(display);
+    if (count == -1)
+      return -1;
+    dispatched += count;
+  }
+
+  // Events already queued are handled now rather than after the next wait.
+  if (dispatched > 0)
+  {
+    wl_display_cancel_read(display);
+    wl_display_flush(display);
+    return dispatched;
+  }
+
+  while (wl_display_flush(display) == -1)
+  {
+    if (errno != EAGAIN)
+    {
+      wl_display_cancel_read(display);
+      return -1;
+    }
+
+    // The socket is full; wait for the compositor to drain it.
+    struct pollfd pfd = {.fd = wl_display_get_fd(display), .events = POLLOUT};
+    int ready = poll(&pfd, 1, wm->wait_timeout_ms);
+    if (ready == 0)
+      break;
+    if (ready == -1 && errno != EINTR)
+    {
+      wl_display_cancel_read(display);
+      return -1;
+    }
+  }
+
+  int revents = glps_event_loop_poll(&wm->event_loop,
+                                     wl_display_get_fd(display),
+                                     __wait_timeout_ms(wm));
+  if (revents == -1)
+  {
+    wl_display_cancel_read(display);
+    return errno == EINTR ? 0 : -1;
+  }
+
+  if (revents & (POLLIN | POLLERR | POLLHUP))
+  {
+    if (wl_display_read_events(display) == -1)
+      return -1;
+  }
+  else
+  {
+    wl_display_cancel_read(display);
+  }
+
+  return wl_display_dispatch_pending(display);
+}
+
+void glps_wl_latch_input(glps_WindowManager *wm)
+{
+  struct wl_display *display = wm->wayland_ctx->wl_display;
+
+  // Pick up what has reached the socket since the last dispatch, without
+  // waiting for more. The reader thread already does this on its own.
+  if (!wm->wayland_ctx->reader.running && wl_display_prepare_read(display) == 0)
+  {
+    struct pollfd pfd = {.fd = wl_display_get_fd(display), .events = POLLIN};
+    if (poll(&pfd, 1, 0) > 0)
+      wl_display_read_events(display);
+    else
+      wl_display_cancel_read(display);
+  }
+
+  // Pointer frames merge their motion, so the input state ends up at the
+  // newest position.
+  wl_display_dispatch_pending(display);
+}
+
 bool glps_wl_should_close(glps_WindowManager *wm)
 {
-  if (wl_display_dispatch(wm->wayland_ctx->wl_display) == -1)
+  if (__dispatch_display(wm) == -1)
     return true;
   else if (wm->should_close)
     return true;
 
+  __detect_stalled_windows(wm);
   return false;
 }
 
@@ -1586,12 +3520,15 @@ void glps_wl_destroy(glps_WindowManager *wm)
   {
     return;
   }
-  glps_egl_destroy(wm);
+  glps_wl_set_event_thread(wm, false);
   _cleanup_wl(wm);
 }
 
 void glps_wl_window_destroy(glps_WindowManager *wm, size_t window_id)
 {
+  if (__window_release(wm, window_id))
+    return;
+
   __window_destroy(wm, window_id);
 }
 
@@ -1652,6 +3589,8 @@ bool glps_wl_init(glps_WindowManager *wm)
                            wm);
 
   wl_display_roundtrip(wm->wayland_ctx->wl_display);
+  // Receive the initial state of the outputs bound above.
+  wl_display_roundtrip(wm->wayland_ctx->wl_display);
 
   if (wm->wayland_ctx->xdg_wm_base)
   {
@@ -1684,24 +3623,20 @@ bool glps_wl_init(glps_WindowManager *wm)
 
 void glps_wl_cursor_change(glps_WindowManager* wm, GLPS_CURSOR_TYPE user_cursor)
 {
-  /*
-  if(!wm || !wm->wayland_ctx)
+  if (!wm || !wm->wayland_ctx)
   {
     LOG_ERROR("Window manager invalid. Couldn't update cursor");
     return;
   }
-   LPCSTR cursor_id;
-  switch(cursor_type) {
-    case GLPS_CURSOR_ARROW: cursor_id = IDC_ARROW; break;
-    case GLPS_CURSOR_IBEAM: cursor_id = IDC_IBEAM; break;
-    case GLPS_CURSOR_CROSSHAIR: cursor_id = IDC_CROSS; break;
-    case GLPS_CURSOR_HAND: cursor_id = IDC_HAND; break;
-    case GLPS_CURSOR_HRESIZE: cursor_id = IDC_SIZEWE; break;
-    case GLPS_CURSOR_VRESIZE: cursor_id = IDC_SIZENS; break;
-    default: cursor_id = IDC_ARROW;
+
+  if ((int)user_cursor < 0 || user_cursor >= GLPS_CURSOR_TYPE_COUNT)
+  {
+    LOG_ERROR("Unknown cursor type.");
+    return;
   }
 
-  */
-  
+  // Applied now if the pointer is over a window, otherwise on its next enter.
+  wm->wayland_ctx->cursor_type = user_cursor;
+  __update_cursor(wm, false);
 }
 
@@ -1,14 +1,19 @@
+#include <glps_trace.h>
 #include <glps_wgl_context.h>
 
 #include "utils/logger/pico_logger.h"
 
 void glps_wgl_make_ctx_current(glps_WindowManager *wm, size_t window_id) {
+  uint64_t trace_start = GLPS_TRACE_BEGIN();
   wglMakeCurrent(wm->windows[window_id]->hdc, wm->win32_ctx->hglrc);
+  GLPS_TRACE_END("wglMakeCurrent", trace_start);
 }
 void *glps_wgl_get_proc_addr(const char *name) {
     return (void *)wglGetProcAddress(name);
 }
 void glps_wgl_swap_buffers(glps_WindowManager *wm, size_t window_id) {
+  uint64_t trace_start = GLPS_TRACE_BEGIN();
   SwapBuffers(wm->windows[window_id]->hdc);
+  GLPS_TRACE_END("SwapBuffers", trace_start);
 }
 void glps_wgl_destroy(glps_WindowManager *wm);
@@ -1,4 +1,10 @@
 #include <glps_common.h>
+#include <glps_event_loop.h>
+#include <glps_frame_stats.h>
+#include <glps_gpu_timer.h>
+#include <glps_input_state.h>
+#include <glps_stats.h>
+#include <glps_trace.h>
 #include "utils/logger/pico_logger.h"
 #ifndef _WIN32_WINNT
 #define _WIN32_WINNT 0x0601 // Windows 7 or newer
@@ -159,12 +165,14 @@ void glps_win32_attach_to_clipboard(glps_WindowManager *wm, char *mime,
     return;
   }
 
+  uint64_t trace_start = GLPS_TRACE_BEGIN();
   if (!SetClipboardData(CF_TEXT, hGlobal))
   {
     LOG_ERROR("Failed to set clipboard data.");
     GlobalFree(hGlobal);
   }
   CloseClipboard();
+  GLPS_TRACE_END("clipboard_write", trace_start);
 }
 
 void glps_win32_get_from_clipboard(glps_WindowManager *wm, char *data,
@@ -176,7 +184,9 @@ void glps_win32_get_from_clipboard(glps_WindowManager *wm, char *data,
     return;
   }
 
+  uint64_t trace_start = GLPS_TRACE_BEGIN();
   HANDLE hData = GetClipboardData(CF_TEXT);
+  GLPS_TRACE_END("clipboard_read", trace_start);
   if (!hData)
   {
     LOG_ERROR("Failed to get clipboard data.");
@@ -200,6 +210,39 @@ void glps_win32_get_from_clipboard(glps_WindowManager *wm, char *data,
   CloseClipboard();
 }
 
+/* Whether a message belongs to an event class the window subscribed to. */
+static bool __wants_message(unsigned int event_mask, UINT msg)
+{
+  switch (msg)
+  {
+  // Pointer enter is detected from the first motion message.
+  case WM_MOUSEMOVE:
+    return event_mask & (GLPS_EVENT_POINTER_MOTION | GLPS_EVENT_POINTER_CROSSING);
+  case WM_MOUSELEAVE:
+    return event_mask & GLPS_EVENT_POINTER_CROSSING;
+  case WM_LBUTTONDOWN:
+  case WM_LBUTTONUP:
+  case WM_RBUTTONDOWN:
+  case WM_RBUTTONUP:
+  case WM_MBUTTONDOWN:
+  case WM_MBUTTONUP:
+  case WM_XBUTTONDOWN:
+  case WM_XBUTTONUP:
+    return event_mask & GLPS_EVENT_POINTER_BUTTON;
+  case WM_MOUSEWHEEL:
+  case WM_MOUSEHWHEEL:
+    return event_mask & GLPS_EVENT_POINTER_SCROLL;
+  case WM_KEYDOWN:
+  case WM_KEYUP:
+    return event_mask & GLPS_EVENT_KEYBOARD;
+  case WM_SETFOCUS:
+  case WM_KILLFOCUS:
+    return event_mask & GLPS_EVENT_FOCUS;
+  default:
+    return true;
+  }
+}
+
 static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
                                 LPARAM lParam)
 {
@@ -209,6 +252,22 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
   POINT p = {.x = -1, .y = -1};
   static bool key_states[256] = {false};
 
+  if (window_id >= 0 && wm != NULL &&
+      !__wants_message(wm->windows[window_id]->event_mask, msg))
+  {
+    return DefWindowProc(hwnd, msg, wParam, lParam);
+  }
+
+  // Input redraws windows rendered on demand; requests merge until WM_PAINT.
+  if (window_id >= 0 && wm != NULL &&
+      ((msg >= WM_MOUSEFIRST && msg <= WM_MOUSELAST) ||
+       (msg >= WM_KEYFIRST && msg <= WM_KEYLAST) || msg == WM_SIZE) &&
+      !wm->windows[window_id]->redraw_requested)
+  {
+    wm->windows[window_id]->redraw_requested = true;
+    InvalidateRect(hwnd, NULL, FALSE);
+  }
+
   switch (msg)
   {
     case WM_DESTROY:
@@ -221,6 +280,8 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
       if (!window)
         break;
 
+      glps_gpu_timer_destroy(&window->gpu_timer);
+
       if (window->hdc) {
         wglMakeCurrent(NULL, NULL);
         ReleaseDC(window->hwnd, window->hdc);
@@ -264,6 +325,9 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
       break;
     }
 
+    glps_input_state_key(&wm->windows[window_id]->input,
+                         MapVirtualKey(wParam, MAPVK_VK_TO_VSC), true);
+
     if (!(lParam & 0x40000000))
     { // Prevent auto-repeat
       if (wParam < 256 && !key_states[wParam])
@@ -309,6 +373,9 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
       break;
     }
 
+    glps_input_state_key(&wm->windows[window_id]->input,
+                         MapVirtualKey(wParam, MAPVK_VK_TO_VSC), false);
+
     if (wParam < 256)
     {
       key_states[wParam] = false;
@@ -353,6 +420,8 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
       break;
     }
 
+    glps_input_state_focus(&wm->windows[window_id]->input, true);
+
     if (wm->callbacks.keyboard_enter_callback)
     {
       wm->callbacks.keyboard_enter_callback(window_id,
@@ -368,6 +437,8 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
       break;
     }
 
+    glps_input_state_focus(&wm->windows[window_id]->input, false);
+
     if (wm->callbacks.keyboard_leave_callback)
     {
       wm->callbacks.keyboard_leave_callback(window_id,
@@ -388,10 +459,24 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
       break;
     }
 
-    if (wm->callbacks.window_frame_update_callback)
+    wm->windows[window_id]->redraw_requested = false;
+
+    if (wm->callbacks.window_frame_update_callback &&
+        wm->windows[window_id]->hidden_reasons == 0)
     {
+      glps_Win32Window *window = wm->windows[window_id];
+      uint64_t trace_start = GLPS_TRACE_BEGIN();
+      glps_frame_stats_begin(&window->frame_stats);
       wm->callbacks.window_frame_update_callback(
           window_id, wm->callbacks.window_frame_update_data);
+      GLPS_TRACE_END("frame_callback", trace_start);
+
+      // The callback may have destroyed the window.
+      if ((size_t)window_id < wm->window_count &&
+          wm->windows[window_id] == window)
+      {
+        glps_frame_stats_end(&window->frame_stats);
+      }
     }
 
     EndPaint(hwnd, &ps);
@@ -404,6 +489,29 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
     {
       return -1;
     }
+    {
+      glps_Win32Window *window = wm->windows[window_id];
+      bool was_visible = window->hidden_reasons == 0;
+      if (wParam == SIZE_MINIMIZED)
+      {
+        window->hidden_reasons |= GLPS_HIDDEN_MINIMIZED;
+      }
+      else
+      {
+        window->hidden_reasons &= ~GLPS_HIDDEN_MINIMIZED;
+        window->properties.width = LOWORD(lParam);
+        window->properties.height = HIWORD(lParam);
+      }
+
+      bool visible = window->hidden_reasons == 0;
+      if (visible != was_visible && wm->callbacks.window_visibility_callback)
+      {
+        wm->callbacks.window_visibility_callback(
+            window_id, visible, wm->callbacks.window_visibility_data);
+      }
+      if (!visible)
+        break;
+    }
     RECT rect;
     if (GetWindowRect(hwnd, &rect))
     {
@@ -411,8 +519,10 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
       int height = rect.bottom - rect.top;
       if (wm->callbacks.window_resize_callback)
       {
+        uint64_t trace_start = GLPS_TRACE_BEGIN();
         wm->callbacks.window_resize_callback(window_id, width, height,
                                              wm->callbacks.window_resize_data);
+        GLPS_TRACE_END("resize_callback", trace_start);
       }
     }
 
@@ -455,6 +565,9 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
       TrackMouseEvent(&tme);
     }
 
+    wm->windows[window_id]->input.pointer_inside = true;
+    glps_input_state_motion(&wm->windows[window_id]->input, x, y);
+
     if (wm->callbacks.mouse_move_callback)
     {
       wm->callbacks.mouse_move_callback(window_id, (double)x, (double)y,
@@ -465,6 +578,8 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
 
   case WM_MOUSELEAVE:
     is_mouse_in_window = false;
+    if (window_id >= 0 && wm != NULL)
+      wm->windows[window_id]->input.pointer_inside = false;
 
     if (wm && wm->callbacks.mouse_leave_callback)
     {
@@ -479,6 +594,9 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
       break;
     }
 
+    glps_input_state_button(&wm->windows[window_id]->input,
+                            GLPS_MOUSE_BUTTON_LEFT, true);
+
     if (wm->callbacks.mouse_click_callback)
     {
       wm->callbacks.mouse_click_callback(window_id, true,
@@ -492,6 +610,9 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
       break;
     }
 
+    glps_input_state_button(&wm->windows[window_id]->input,
+                            GLPS_MOUSE_BUTTON_LEFT, false);
+
     if (wm->callbacks.mouse_click_callback)
     {
       wm->callbacks.mouse_click_callback(window_id, false,
@@ -499,12 +620,43 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
     }
     break;
 
+  case WM_RBUTTONDOWN:
+  case WM_RBUTTONUP:
+  case WM_MBUTTONDOWN:
+  case WM_MBUTTONUP:
+  case WM_XBUTTONDOWN:
+  case WM_XBUTTONUP:
+  {
+    if (window_id < 0 || wm == NULL)
+    {
+      break;
+    }
+
+    // Only the left button reaches mouse_click_callback; the others are
+    // tracked for the input state.
+    GLPS_MOUSE_BUTTON button;
+    if (msg == WM_RBUTTONDOWN || msg == WM_RBUTTONUP)
+      button = GLPS_MOUSE_BUTTON_RIGHT;
+    else if (msg == WM_MBUTTONDOWN || msg == WM_MBUTTONUP)
+      button = GLPS_MOUSE_BUTTON_MIDDLE;
+    else
+      button = GET_XBUTTON_WPARAM(wParam) == XBUTTON1 ? GLPS_MOUSE_BUTTON_BACK
+                                                      : GLPS_MOUSE_BUTTON_FORWARD;
+
+    glps_input_state_button(&wm->windows[window_id]->input, button,
+                            msg == WM_RBUTTONDOWN || msg == WM_MBUTTONDOWN ||
+                                msg == WM_XBUTTONDOWN);
+    break;
+  }
+
   case WM_MOUSEWHEEL:
     if (window_id < 0 || wm == NULL)
     {
       break;
     }
     DOUBLE delta = (DOUBLE)(GET_WHEEL_DELTA_WPARAM(wParam) / WHEEL_DELTA);
+    glps_input_state_scroll(&wm->windows[window_id]->input, GLPS_SCROLL_V_AXIS,
+                            delta);
     DWORD extra_info = GetMessageExtraInfo();
 
     // TODO: Improve this to have wider source support.
@@ -602,8 +754,183 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam,
   return 0;
 }
 
+/* Trace span name of an input message's dispatch, NULL for other messages. */
+static const char *__input_span_name(UINT msg)
+{
+  switch (msg)
+  {
+  case WM_MOUSEMOVE:
+    return "motion_input";
+  case WM_MOUSELEAVE:
+    return "crossing_input";
+  case WM_LBUTTONDOWN:
+  case WM_LBUTTONUP:
+  case WM_RBUTTONDOWN:
+  case WM_RBUTTONUP:
+  case WM_MBUTTONDOWN:
+  case WM_MBUTTONUP:
+  case WM_XBUTTONDOWN:
+  case WM_XBUTTONUP:
+    return "button_input";
+  case WM_MOUSEWHEEL:
+  case WM_MOUSEHWHEEL:
+    return "scroll_input";
+  case WM_KEYDOWN:
+  case WM_KEYUP:
+  case WM_CHAR:
+    return "key_input";
+  case WM_SETFOCUS:
+  case WM_KILLFOCUS:
+    return "focus_input";
+  default:
+    return NULL;
+  }
+}
+
+/* Runs WndProc inside a trace span for input messages, from the message to
+ * its callbacks returning. */
+static LRESULT CALLBACK __traced_wnd_proc(HWND hwnd, UINT msg, WPARAM wParam,
+                                          LPARAM lParam)
+{
+  const char *span_name = __input_span_name(msg);
+  uint64_t span = span_name != NULL ? GLPS_TRACE_BEGIN() : 0;
+  LRESULT result = WndProc(hwnd, msg, wParam, lParam);
+  GLPS_TRACE_END(span_name, span);
+  return result;
+}
+
+/* Whether any window has a frame to draw before the next message. */
+static bool __needs_frame(glps_WindowManager *wm)
+{
+  if (wm->window_count == 0)
+    return true;
+
+  for (size_t i = 0; i < wm->window_count; ++i)
+  {
+    glps_Win32Window *window = wm->windows[i];
+    if (window == NULL || window->hidden_reasons != 0)
+      continue;
+    if (window->render_mode == GLPS_RENDER_CONTINUOUS || window->redraw_requested)
+      return true;
+  }
+
+  return false;
+}
+
+static void __fill_output(HMONITOR monitor, glps_Output *output)
+{
+  MONITORINFOEXA info = {0};
+  DEVMODEA mode = {0};
+  info.cbSize = sizeof(info);
+  mode.dmSize = sizeof(mode);
+
+  *output = (glps_Output){0};
+  output->id = (uint32_t)(uintptr_t)monitor;
+  output->scale = 1.0;
+  output->refresh_hz = GLPS_FALLBACK_REFRESH_HZ;
+
+  if (!GetMonitorInfoA(monitor, (MONITORINFO *)&info))
+    return;
+
+  snprintf(output->name, sizeof(output->name), "%s", info.szDevice);
+  output->x = info.rcMonitor.left;
+  output->y = info.rcMonitor.top;
+  output->logical_width = info.rcMonitor.right - info.rcMonitor.left;
+  output->logical_height = info.rcMonitor.bottom - info.rcMonitor.top;
+  output->width = output->logical_width;
+  output->height = output->logical_height;
+
+  if (EnumDisplaySettingsA(info.szDevice, ENUM_CURRENT_SETTINGS, &mode))
+  {
+    output->width = (int)mode.dmPelsWidth;
+    output->height = (int)mode.dmPelsHeight;
+    // 0 and 1 stand for the hardware default rate.
+    if (mode.dmDisplayFrequency > 1)
+      output->refresh_hz = (double)mode.dmDisplayFrequency;
+  }
+
+  if (output->logical_width > 0)
+    output->scale = (double)output->width / output->logical_width;
+}
+
+struct __output_enum
+{
+  glps_Output *outputs;
+  size_t max_outputs;
+  size_t count;
+};
+
+static BOOL CALLBACK __enum_output(HMONITOR monitor, HDC hdc, LPRECT rect,
+                                   LPARAM data)
+{
+  struct __output_enum *e = (struct __output_enum *)data;
+
+  if (e->outputs != NULL && e->count < e->max_outputs)
+    __fill_output(monitor, &e->outputs[e->count]);
+  e->count++;
+
+  return TRUE;
+}
+
+size_t glps_win32_get_outputs(glps_WindowManager *wm, glps_Output *outputs,
+                              size_t max_outputs)
+{
+  // Monitors are enumerated on every call, so the list is always current.
+  struct __output_enum e = {.outputs = outputs, .max_outputs = max_outputs};
+  EnumDisplayMonitors(NULL, NULL, __enum_output, (LPARAM)&e);
+  return e.count;
+}
+
+bool glps_win32_window_get_output(glps_WindowManager *wm, size_t window_id,
+                                  glps_Output *output)
+{
+  HMONITOR monitor =
+      MonitorFromWindow(wm->windows[window_id]->hwnd, MONITOR_DEFAULTTONEAREST);
+  if (monitor == NULL)
+    return false;
+
+  __fill_output(monitor, output);
+  return true;
+}
+
+void glps_win32_latch_input(glps_WindowManager *wm, size_t window_id) {
+  HWND hwnd = wm->windows[window_id]->hwnd;
+  MSG msg, latest;
+  bool moved = false;
+  uint64_t merged = 0;
+
+  // Drain the window's moves up to its first button message and dispatch only
+  // the newest one; a press must still see where the pointer was.
+  while (PeekMessage(&msg, hwnd, WM_MOUSEFIRST, WM_MOUSELAST, PM_NOREMOVE) &&
+         msg.message == WM_MOUSEMOVE) {
+    PeekMessage(&msg, hwnd, WM_MOUSEMOVE, WM_MOUSEMOVE, PM_REMOVE);
+    merged += moved;
+    latest = msg;
+    moved = true;
+  }
+
+  if (moved) {
+    glps_stats_add(GLPS_STAT_COALESCED_EVENTS, merged);
+    TranslateMessage(&latest);
+    DispatchMessage(&latest);
+  }
+}
+
 bool glps_win32_should_close(glps_WindowManager* wm) {
   MSG msg;
+
+  // Sleep until a message arrives or a task is posted when there is nothing
+  // to draw, or until the caller's deadline.
+  if (!__needs_frame(wm) || wm->wait_timeout_ms >= 0) {
+    HANDLE wake_event = glps_event_loop_handle(&wm->event_loop);
+    DWORD timeout =
+        wm->wait_timeout_ms < 0 ? INFINITE : (DWORD)wm->wait_timeout_ms;
+    if (wake_event != NULL)
+      MsgWaitForMultipleObjects(1, &wake_event, FALSE, timeout, QS_ALLINPUT);
+    else
+      MsgWaitForMultipleObjects(0, NULL, FALSE, timeout, QS_ALLINPUT);
+  }
+
   while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
     if (msg.message == WM_QUIT) {
       return true;
@@ -639,7 +966,7 @@ static void __init_window_class(glps_WindowManager *wm,
   wm->wc = (WNDCLASSEX){0};
   wm->wc.cbSize = sizeof(WNDCLASSEX);
   wm->wc.style = 0;
-  wm->wc.lpfnWndProc = WndProc;
+  wm->wc.lpfnWndProc = __traced_wnd_proc;
   wm->wc.cbClsExtra = 0;
   wm->wc.cbWndExtra = 0;
   wm->wc.hInstance = hInstance;
@@ -736,12 +1063,8 @@ static BOOL SetPixelFormatForOpenGL(HDC hdc)
 void glps_win32_get_window_dimensions(glps_WindowManager *wm, size_t window_id,
                                       int *width, int *height)
 {
-  RECT rect;
-  if (GetClientRect(wm->windows[window_id]->hwnd, &rect))
-  {
-    *width = rect.right - rect.left;
-    *height = rect.bottom - rect.top;
-  }
+  *width = wm->windows[window_id]->properties.width;
+  *height = wm->windows[window_id]->properties.height;
 }
 
 ssize_t glps_win32_window_create(glps_WindowManager *wm, const char *title,
@@ -758,6 +1081,16 @@ ssize_t glps_win32_window_create(glps_WindowManager *wm, const char *title,
                    MB_ICONEXCLAMATION | MB_OK);
         return -1;
     }
+    glps_frame_stats_init(&win32_window->frame_stats);
+    win32_window->gpu_timer = (glps_GpuTimer){0};
+    win32_window->dynamic_resolution = (glps_DynamicResolution){0};
+    win32_window->schedule = (glps_FrameSchedule){0};
+    win32_window->render_scale = 1.0;
+    win32_window->hidden_reasons = 0;
+    win32_window->render_mode = GLPS_RENDER_CONTINUOUS;
+    win32_window->redraw_requested = false;
+    win32_window->input = (glps_InputState){0};
+    win32_window->event_mask = GLPS_EVENT_ALL;
 
     RECT rect = { 0, 0, width, height };
     AdjustWindowRect(&rect, WS_OVERLAPPEDWINDOW, FALSE);
@@ -1,4 +1,12 @@
 #include "glps_window_manager.h"
+#include "glps_dynamic_resolution.h"
+#include "glps_event_loop.h"
+#include "glps_frame_scheduler.h"
+#include "glps_frame_stats.h"
+#include "glps_gpu_timer.h"
+#include "glps_main_loop.h"
+#include "glps_stats.h"
+#include "glps_trace.h"
 #include "utils/logger/pico_logger.h"
 
 #include <stddef.h>
@@ -81,6 +89,23 @@ void glps_wm_set_mouse_move_callback(
   wm->callbacks.mouse_move_data = data;
 }
 
+void glps_wm_set_late_latch_callback(
+    glps_WindowManager *wm,
+    void (*late_latch_callback)(size_t window_id, double mouse_x,
+                                double mouse_y, void *data),
+    void *data)
+{
+
+  if (wm == NULL)
+  {
+    LOG_CRITICAL("Window Manager is NULL.");
+    return;
+  }
+
+  wm->callbacks.late_latch_callback = late_latch_callback;
+  wm->callbacks.late_latch_data = data;
+}
+
 void glps_wm_set_mouse_click_callback(
     glps_WindowManager *wm,
     void (*mouse_click_callback)(size_t window_id, bool state, void *data),
@@ -288,6 +313,18 @@ void glps_wm_start_drag_n_drop(
 #endif
 }
 
+static void __set_render_scale(glps_WindowManager *wm, size_t window_id,
+                               double scale)
+{
+#ifdef GLPS_USE_WAYLAND
+  glps_wl_window_set_render_scale(wm, window_id, scale);
+#else
+  // Without compositor-side scaling the application renders at the render
+  // dimensions and upscales the result itself.
+  wm->windows[window_id]->render_scale = scale;
+#endif
+}
+
 void glps_wm_swap_interval(glps_WindowManager *wm, unsigned int swap_interval)
 {
 #if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
@@ -295,15 +332,86 @@ void glps_wm_swap_interval(glps_WindowManager *wm, unsigned int swap_interval)
 #endif
 }
 
+/* Takes the input that arrived while the frame was drawn and hands the
+ * freshest pointer position to the application. Returns false if dispatching
+ * destroyed the window. */
+static bool __late_latch(glps_WindowManager *wm, size_t window_id)
+{
+  // Dispatching may draw another window, whose swap must not latch again.
+  if (wm->latching)
+    return true;
+
+  uint64_t span = GLPS_TRACE_BEGIN();
+  wm->latching = true;
+#ifdef GLPS_USE_WAYLAND
+  glps_wl_latch_input(wm);
+#endif
+#ifdef GLPS_USE_WIN32
+  glps_win32_latch_input(wm, window_id);
+#endif
+#ifdef GLPS_USE_X11
+  glps_x11_latch_input(wm, window_id);
+#endif
+  wm->latching = false;
+  GLPS_TRACE_END("late_latch", span);
+
+  if (window_id >= wm->window_count || wm->windows[window_id] == NULL)
+    return false;
+
+  glps_InputState *input = &wm->windows[window_id]->input;
+  if (input->pointer_inside && wm->callbacks.late_latch_callback != NULL)
+  {
+    wm->callbacks.late_latch_callback(window_id, input->pointer_x,
+                                      input->pointer_y,
+                                      wm->callbacks.late_latch_data);
+  }
+
+  return true;
+}
+
 void glps_wm_swap_buffers(glps_WindowManager *wm, size_t window_id)
 {
+  if (wm->callbacks.late_latch_callback != NULL &&
+      !__late_latch(wm, window_id))
+    return;
+
+  glps_gpu_timer_end(&wm->windows[window_id]->gpu_timer);
+
+#ifdef GLPS_USE_WAYLAND
+  // The frame is dropped until the compositor configured the surface.
+  if (wm->windows[window_id]->awaiting_map)
+    return;
+#endif
+
+  uint64_t swap_start = glps_frame_stats_now_ns();
+
 #if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
   glps_egl_swap_buffers(wm, window_id);
 #endif
 
+#ifdef GLPS_USE_X11
+  glps_x11_window_swapped(wm, window_id);
+#endif
+
 #ifdef GLPS_USE_WIN32
   glps_wgl_swap_buffers(wm, window_id);
 #endif
+
+  glps_frame_stats_add_swap(&wm->windows[window_id]->frame_stats,
+                            glps_frame_stats_now_ns() - swap_start);
+
+  // The next frame is timed from here, whether or not the application binds
+  // its context again before drawing it.
+  glps_gpu_timer_begin(&wm->windows[window_id]->gpu_timer,
+                       &wm->windows[window_id]->frame_stats);
+
+  double scale;
+  if (glps_dynamic_resolution_update(&wm->windows[window_id]->dynamic_resolution,
+                                     &wm->windows[window_id]->frame_stats,
+                                     &scale))
+  {
+    __set_render_scale(wm, window_id, scale);
+  }
 }
 
 void glps_wm_window_set_resize_callback(
@@ -354,6 +462,77 @@ void glps_wm_window_set_close_callback(
   wm->callbacks.window_close_data = data;
 }
 
+void glps_wm_window_set_visibility_callback(
+    glps_WindowManager *wm,
+    void (*window_visibility_callback)(size_t window_id, bool visible,
+                                       void *data),
+    void *data)
+{
+
+  if (wm == NULL)
+  {
+    LOG_ERROR("Window Manager is NULL.");
+    return;
+  }
+
+  wm->callbacks.window_visibility_callback = window_visibility_callback;
+  wm->callbacks.window_visibility_data = data;
+}
+
+void glps_wm_window_set_render_mode(glps_WindowManager *wm, size_t window_id,
+                                    GLPS_RENDER_MODE mode)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
+  {
+    LOG_ERROR("Couldn't set render mode. Invalid parameters.");
+    return;
+  }
+
+  wm->windows[window_id]->render_mode = mode;
+
+  // Draw once in the new mode so the window is never left stale.
+  glps_wm_request_redraw(wm, window_id);
+}
+
+void glps_wm_request_redraw(glps_WindowManager *wm, size_t window_id)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
+  {
+    LOG_ERROR("Couldn't request redraw. Invalid parameters.");
+    return;
+  }
+
+#ifdef GLPS_USE_WAYLAND
+  glps_wl_window_request_redraw(wm, window_id);
+#endif
+
+#ifdef GLPS_USE_WIN32
+  if (!wm->windows[window_id]->redraw_requested)
+  {
+    wm->windows[window_id]->redraw_requested = true;
+    InvalidateRect(wm->windows[window_id]->hwnd, NULL, FALSE);
+  }
+#endif
+
+#ifdef GLPS_USE_X11
+  wm->windows[window_id]->redraw_requested = true;
+#endif
+}
+
+bool glps_wm_window_is_visible(glps_WindowManager *wm, size_t window_id)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
+  {
+    LOG_ERROR("Couldn't get window visibility. Invalid parameters.");
+    return false;
+  }
+
+  return wm->windows[window_id]->hidden_reasons == 0;
+}
+
 glps_WindowManager *glps_wm_init(void)
 {
 
@@ -364,6 +543,14 @@ glps_WindowManager *glps_wm_init(void)
     LOG_ERROR("Failed to allocate memory for glps_WindowManager");
     return NULL;
   }
+  glps_event_loop_init(&wm->event_loop);
+  wm->wait_timeout_ms = -1;
+  wm->stats.fd = -1;
+  // Lets glps-top attach to applications that never asked for it.
+  if (getenv("GLPS_STATS_PAGE") != NULL)
+  {
+    glps_stats_page_open(&wm->stats);
+  }
 #ifdef GLPS_USE_WAYLAND
   if (!glps_wl_init(wm))
   {
@@ -392,6 +579,9 @@ void glps_wm_set_window_ctx_curr(glps_WindowManager *wm, size_t window_id)
 #ifdef GLPS_USE_WIN32
   glps_wgl_make_ctx_current(wm, window_id);
 #endif
+
+  glps_gpu_timer_begin(&wm->windows[window_id]->gpu_timer,
+                       &wm->windows[window_id]->frame_stats);
 }
 
 void glps_wm_window_get_dimensions(glps_WindowManager *wm, size_t window_id,
@@ -423,7 +613,7 @@ void glps_wm_window_get_dimensions(glps_WindowManager *wm, size_t window_id,
 
 void *glps_get_proc_addr(const char *name)
 {
-#ifdef GLPS_USE_WAYLAND
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
   return glps_egl_get_proc_addr(name);
 #endif
 #ifdef GLPS_USE_WIN32
@@ -477,68 +667,460 @@ void glps_wm_window_destroy(glps_WindowManager *wm, size_t window_id)
 #ifdef GLPS_USE_WIN32
 
 #endif
+
+#ifdef GLPS_USE_X11
+  glps_x11_window_destroy(wm, window_id);
+#endif
+}
+
+size_t glps_wm_window_pool_reserve(glps_WindowManager *wm, size_t count)
+{
+  if (wm == NULL)
+  {
+    LOG_ERROR("Couldn't reserve pooled windows. Window manager is NULL.");
+    return 0;
+  }
+
+#ifdef GLPS_USE_WAYLAND
+  return glps_wl_window_pool_reserve(wm, count);
+#else
+  (void)count;
+  LOG_WARNING("Window pooling is not supported on this platform.");
+  return 0;
+#endif
+}
+
+ssize_t glps_wm_popup_create(glps_WindowManager *wm, size_t parent_id, int x,
+                             int y, int width, int height, bool grab)
+{
+  if (wm == NULL || parent_id >= wm->window_count ||
+      wm->windows[parent_id] == NULL || width <= 0 || height <= 0)
+  {
+    LOG_ERROR("Couldn't create popup. Invalid parameters.");
+    return -1;
+  }
+
+#ifdef GLPS_USE_WAYLAND
+  return glps_wl_popup_create(wm, parent_id, x, y, width, height, grab);
+#elif defined(GLPS_USE_X11)
+  return glps_x11_popup_create(wm, parent_id, x, y, width, height, grab);
+#else
+  (void)x;
+  (void)y;
+  (void)grab;
+  LOG_WARNING("Popups are not supported on this platform.");
+  return -1;
+#endif
+}
+
+ssize_t glps_wm_subsurface_create(glps_WindowManager *wm, size_t parent_id,
+                                  int x, int y, int width, int height)
+{
+  if (wm == NULL || parent_id >= wm->window_count ||
+      wm->windows[parent_id] == NULL || width <= 0 || height <= 0)
+  {
+    LOG_ERROR("Couldn't create subsurface. Invalid parameters.");
+    return -1;
+  }
+
+#ifdef GLPS_USE_WAYLAND
+  return glps_wl_subsurface_create(wm, parent_id, x, y, width, height);
+#elif defined(GLPS_USE_X11)
+  return glps_x11_subsurface_create(wm, parent_id, x, y, width, height);
+#else
+  (void)x;
+  (void)y;
+  LOG_WARNING("Subsurfaces are not supported on this platform.");
+  return -1;
+#endif
+}
+
+void glps_wm_subsurface_set_position(glps_WindowManager *wm, size_t window_id,
+                                     int x, int y)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
+  {
+    LOG_ERROR("Couldn't move subsurface. Invalid parameters.");
+    return;
+  }
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm->windows[window_id]->role != GLPS_WINDOW_SUBSURFACE)
+  {
+    LOG_ERROR("Couldn't move subsurface. Window %zu is not a subsurface.",
+              window_id);
+    return;
+  }
+#endif
+
+#ifdef GLPS_USE_WAYLAND
+  glps_wl_subsurface_set_position(wm, window_id, x, y);
+#elif defined(GLPS_USE_X11)
+  glps_x11_subsurface_set_position(wm, window_id, x, y);
+#else
+  (void)x;
+  (void)y;
+  LOG_WARNING("Subsurfaces are not supported on this platform.");
+#endif
 }
 
 double glps_wm_get_fps(glps_WindowManager *wm, size_t window_id)
 {
-  if (!wm->windows[window_id]->fps_is_init)
+  glps_FrameStats stats = glps_wm_get_frame_stats(wm, window_id);
+  return stats.sample_count > 0 ? stats.fps : 0.0;
+}
+
+size_t glps_wm_get_outputs(glps_WindowManager *wm, glps_Output *outputs,
+                           size_t max_outputs)
+{
+  if (wm == NULL)
   {
+    LOG_ERROR("Couldn't get outputs. Window manager is NULL.");
+    return 0;
+  }
+
 #ifdef GLPS_USE_WAYLAND
-    clock_gettime(CLOCK_MONOTONIC, &wm->windows[window_id]->fps_start_time);
+  return glps_wl_get_outputs(wm, outputs, max_outputs);
 #endif
 
 #ifdef GLPS_USE_WIN32
-    QueryPerformanceCounter(&wm->windows[window_id]->fps_start_time);
-    QueryPerformanceFrequency(&wm->windows[window_id]->fps_freq);
+  return glps_win32_get_outputs(wm, outputs, max_outputs);
 #endif
 
-    wm->windows[window_id]->fps_is_init = true;
-    return 0.0;
-  }
-  else
+#ifdef GLPS_USE_X11
+  return glps_x11_get_outputs(wm, outputs, max_outputs);
+#endif
+}
+
+bool glps_wm_window_get_output(glps_WindowManager *wm, size_t window_id,
+                               glps_Output *output)
+{
+  if (wm == NULL || output == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
   {
+    LOG_ERROR("Couldn't get window output. Invalid parameters.");
+    return false;
+  }
+
 #ifdef GLPS_USE_WAYLAND
-    struct timespec end_time;
-    clock_gettime(CLOCK_MONOTONIC, &end_time);
+  return glps_wl_window_get_output(wm, window_id, output);
+#endif
 
-    double seconds = (double)(end_time.tv_sec - wm->windows[window_id]->fps_start_time.tv_sec);
-    double nanoseconds = (double)(end_time.tv_nsec - wm->windows[window_id]->fps_start_time.tv_nsec);
+#ifdef GLPS_USE_WIN32
+  return glps_win32_window_get_output(wm, window_id, output);
+#endif
 
-    if (nanoseconds < 0)
-    {
-      seconds -= 1.0;
-      nanoseconds += 1e9;
-    }
+#ifdef GLPS_USE_X11
+  return glps_x11_window_get_output(wm, window_id, output);
+#endif
+}
 
-    wm->windows[window_id]->fps_start_time = end_time;
-    return 1.0 / (seconds + nanoseconds / 1e9);
+void glps_wm_window_set_event_mask(glps_WindowManager *wm, size_t window_id,
+                                   unsigned int mask)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
+  {
+    LOG_ERROR("Couldn't set event mask. Invalid parameters.");
+    return;
+  }
+
+  mask &= GLPS_EVENT_ALL;
+
+#ifdef GLPS_USE_WAYLAND
+  glps_wl_window_set_event_mask(wm, window_id, mask);
 #endif
 
 #ifdef GLPS_USE_WIN32
-    LARGE_INTEGER end_time;
-    QueryPerformanceCounter(&end_time);
+  wm->windows[window_id]->event_mask = mask;
+#endif
+
+#ifdef GLPS_USE_X11
+  glps_x11_window_set_event_mask(wm, window_id, mask);
+#endif
+}
+
+glps_InputState glps_wm_get_input_state(glps_WindowManager *wm,
+                                        size_t window_id)
+{
+  glps_InputState state = {0};
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
+  {
+    LOG_ERROR("Couldn't get input state. Invalid window ID or window manager "
+              "is NULL.");
+    return state;
+  }
+
+  return wm->windows[window_id]->input;
+}
+
+glps_FrameStats glps_wm_get_frame_stats(glps_WindowManager *wm,
+                                        size_t window_id)
+{
+  glps_FrameStats stats = {0};
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
+  {
+    LOG_ERROR("Couldn't get frame stats. Invalid window ID or window manager "
+              "is NULL.");
+    return stats;
+  }
+
+  glps_frame_stats_snapshot(&wm->windows[window_id]->frame_stats, &stats);
+  return stats;
+}
+
+void glps_wm_window_set_frame_budget(glps_WindowManager *wm, size_t window_id,
+                                     double budget_ms)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL || budget_ms < 0.0)
+  {
+    LOG_ERROR("Couldn't set frame budget. Invalid parameters.");
+    return;
+  }
+
+  atomic_store_explicit(&wm->windows[window_id]->frame_stats.budget_ns,
+                        (uint64_t)(budget_ms * 1e6), memory_order_relaxed);
+}
+
+void glps_wm_window_set_gpu_timing(glps_WindowManager *wm, size_t window_id,
+                                   bool enabled)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
+  {
+    LOG_ERROR("Couldn't set GPU timing. Invalid parameters.");
+    return;
+  }
+
+  wm->windows[window_id]->gpu_timer.enabled = enabled;
+}
+
+void glps_wm_window_set_render_scale(glps_WindowManager *wm, size_t window_id,
+                                     double scale)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL || scale <= 0.0 || scale > 1.0)
+  {
+    LOG_ERROR("Couldn't set render scale. Invalid parameters.");
+    return;
+  }
+
+  // A manual scale overrides the controller.
+  wm->windows[window_id]->dynamic_resolution.enabled = false;
+  __set_render_scale(wm, window_id, scale);
+}
 
-    double time_taken = (double)(end_time.QuadPart - wm->windows[window_id]->fps_start_time.QuadPart) /
-                        (double)wm->windows[window_id]->fps_freq.QuadPart;
+double glps_wm_window_get_render_scale(glps_WindowManager *wm,
+                                       size_t window_id)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL)
+  {
+    LOG_ERROR("Couldn't get render scale. Invalid parameters.");
+    return 1.0;
+  }
 
-    wm->windows[window_id]->fps_start_time = end_time;
-    return 1.0 / time_taken;
+  return wm->windows[window_id]->render_scale;
+}
+
+void glps_wm_window_get_render_dimensions(glps_WindowManager *wm,
+                                          size_t window_id, int *width,
+                                          int *height)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL || width == NULL || height == NULL)
+  {
+    LOG_ERROR("Couldn't get render dimensions. Invalid parameters.");
+    return;
+  }
+
+#ifdef GLPS_USE_WAYLAND
+  *width = wm->windows[window_id]->buffer_width;
+  *height = wm->windows[window_id]->buffer_height;
+#else
+  int logical_width, logical_height;
+  glps_wm_window_get_dimensions(wm, window_id, &logical_width, &logical_height);
+  glps_dynamic_resolution_buffer_size(logical_width, logical_height,
+                                      wm->windows[window_id]->render_scale,
+                                      width, height);
 #endif
+}
+
+void glps_wm_window_set_dynamic_resolution(glps_WindowManager *wm,
+                                           size_t window_id, bool enabled,
+                                           double target_ms)
+{
+  if (wm == NULL || window_id >= wm->window_count ||
+      wm->windows[window_id] == NULL || (enabled && target_ms <= 0.0))
+  {
+    LOG_ERROR("Couldn't set dynamic resolution. Invalid parameters.");
+    return;
   }
 
-  return -1.0f;
+  glps_DynamicResolution *dr = &wm->windows[window_id]->dynamic_resolution;
+
+  if (!enabled)
+  {
+    dr->enabled = false;
+    return;
+  }
+
+  // GPU times show headroom that vsync-locked frame intervals hide.
+  wm->windows[window_id]->gpu_timer.enabled = true;
+  glps_dynamic_resolution_start(dr, (uint64_t)(target_ms * 1e6));
+  __set_render_scale(wm, window_id, glps_dynamic_resolution_scale(dr));
 }
 
 bool glps_wm_should_close(glps_WindowManager *wm)
 {
+  bool should_close = false;
+
+  // Frames put off for the budget must not sleep past the next period.
+  int wait_timeout_ms = wm->wait_timeout_ms;
+  int frame_timeout_ms = glps_frame_scheduler_timeout_ms(wm);
+  if (frame_timeout_ms >= 0 &&
+      (wait_timeout_ms < 0 || frame_timeout_ms < wait_timeout_ms))
+  {
+    wm->wait_timeout_ms = frame_timeout_ms;
+  }
+
+  uint64_t trace_start = GLPS_TRACE_BEGIN();
 #ifdef GLPS_USE_WAYLAND
-  return glps_wl_should_close(wm);
+  should_close = glps_wl_should_close(wm);
 #endif
 #ifdef GLPS_USE_WIN32
-  return glps_win32_should_close(wm);
+  should_close = glps_win32_should_close(wm);
 #endif
 #ifdef GLPS_USE_X11
-  return glps_x11_should_close(wm);
+  should_close = glps_x11_should_close(wm);
+#endif
+  GLPS_TRACE_END("glps_dispatch", trace_start);
+
+  wm->wait_timeout_ms = wait_timeout_ms;
+
+  trace_start = GLPS_TRACE_BEGIN();
+  glps_event_loop_run(&wm->event_loop);
+  GLPS_TRACE_END("posted_tasks", trace_start);
+
+  if (!should_close)
+  {
+    trace_start = GLPS_TRACE_BEGIN();
+    glps_frame_scheduler_run(wm);
+    GLPS_TRACE_END("frames", trace_start);
+
+    glps_stats_publish(wm);
+  }
+  return should_close;
+}
+
+void glps_wm_run(glps_WindowManager *wm, const glps_LoopDesc *desc)
+{
+  if (wm == NULL || desc == NULL)
+  {
+    LOG_ERROR("Couldn't run main loop. Invalid parameters.");
+    return;
+  }
+
+  glps_MainLoop loop;
+  glps_main_loop_init(&loop, desc);
+
+  uint64_t wait_ns = 0;
+  for (;;)
+  {
+    // Input arriving earlier still wakes the dispatch.
+    wm->wait_timeout_ms = glps_frame_stats_timeout_ms(wait_ns);
+    if (glps_wm_should_close(wm))
+      break;
+
+    wait_ns = glps_main_loop_tick(&loop);
+  }
+
+  wm->wait_timeout_ms = -1;
+}
+
+bool glps_wm_set_stats_page(glps_WindowManager *wm, bool enabled)
+{
+  if (wm == NULL)
+  {
+    LOG_ERROR("Couldn't set stats page. Window manager is NULL.");
+    return false;
+  }
+
+  if (!enabled)
+  {
+    glps_stats_page_close(&wm->stats);
+    return true;
+  }
+
+  return wm->stats.page != NULL || glps_stats_page_open(&wm->stats);
+}
+
+bool glps_wm_post(glps_WindowManager *wm, void (*fn)(void *arg), void *arg)
+{
+  if (wm == NULL || fn == NULL)
+  {
+    LOG_ERROR("Couldn't post task. Invalid parameters.");
+    return false;
+  }
+
+  return glps_event_loop_post(&wm->event_loop, fn, arg);
+}
+
+bool glps_wm_add_fd(glps_WindowManager *wm, int fd, unsigned int events,
+                    void (*callback)(int fd, unsigned int events, void *data),
+                    void *data)
+{
+  if (wm == NULL || fd < 0 || callback == NULL)
+  {
+    LOG_ERROR("Couldn't watch fd. Invalid parameters.");
+    return false;
+  }
+
+#ifdef GLPS_USE_WIN32
+  (void)events;
+  (void)data;
+  LOG_WARNING("Watching descriptors is not supported on this platform.");
+  return false;
+#else
+  return glps_event_loop_add_fd(&wm->event_loop, fd, events, callback, data);
+#endif
+}
+
+void glps_wm_remove_fd(glps_WindowManager *wm, int fd)
+{
+  if (wm == NULL)
+  {
+    LOG_ERROR("Couldn't remove fd. Window manager is NULL.");
+    return;
+  }
+
+#ifndef GLPS_USE_WIN32
+  glps_event_loop_remove_fd(&wm->event_loop, fd);
+#else
+  (void)fd;
+#endif
+}
+
+bool glps_wm_set_event_thread(glps_WindowManager *wm, bool enabled)
+{
+  if (wm == NULL)
+  {
+    LOG_ERROR("Couldn't set event thread. Window manager is NULL.");
+    return false;
+  }
+
+#ifdef GLPS_USE_WAYLAND
+  return glps_wl_set_event_thread(wm, enabled);
+#elif defined(GLPS_USE_X11)
+  return glps_x11_set_event_thread(wm, enabled);
+#else
+  if (enabled)
+    LOG_WARNING("Event reader thread is not supported on this platform.");
+  return !enabled;
 #endif
 }
 
@@ -559,6 +1141,8 @@ void glps_wm_destroy(glps_WindowManager *wm)
 
   if (wm)
   {
+    glps_stats_page_close(&wm->stats);
+    glps_event_loop_destroy(&wm->event_loop);
     free(wm);
     wm = NULL;
   }
@@ -566,6 +1150,11 @@ void glps_wm_destroy(glps_WindowManager *wm)
 
 void glps_wm_window_update(glps_WindowManager *wm, size_t window_id)
 {
+  if (wm->windows[window_id]->render_mode == GLPS_RENDER_ON_DEMAND &&
+      !wm->windows[window_id]->redraw_requested)
+  {
+    return;
+  }
 
 #ifdef GLPS_USE_WAYLAND
   wl_update(wm, window_id);
@@ -585,7 +1174,14 @@ void glps_wm_window_update(glps_WindowManager *wm, size_t window_id)
 
 size_t glps_wm_get_window_count(glps_WindowManager *wm)
 {
-  return wm->window_count;
+  // Slots of destroyed windows stay empty until a new window takes them.
+  size_t count = 0;
+  for (size_t i = 0; i < wm->window_count; ++i)
+  {
+    if (wm->windows[i] != NULL)
+      ++count;
+  }
+  return count;
 }
 
 void glps_wm_window_is_resizable(glps_WindowManager *wm, bool state, size_t window_id)
@@ -610,6 +1206,10 @@ void glps_wm_toggle_window_decorations(glps_WindowManager *wm, bool state, size_
 }
 
 void glps_wm_cursor_change(glps_WindowManager* wm, GLPS_CURSOR_TYPE cursor_type) {
+#ifdef GLPS_USE_WAYLAND
+  glps_wl_cursor_change(wm, cursor_type);
+#endif
+
 #ifdef GLPS_USE_WIN32
   glps_win32_cursor_change(wm, cursor_type);
 #endif
@@ -617,4 +1217,38 @@ void glps_wm_cursor_change(glps_WindowManager* wm, GLPS_CURSOR_TYPE cursor_type)
 #ifdef GLPS_USE_X11
   glps_x11_cursor_change(wm, cursor_type);
 #endif
-}
\ No newline at end of file
+}
+
+ssize_t glps_wm_cursor_create_image(glps_WindowManager *wm,
+                                    const unsigned char *rgba, int width,
+                                    int height, int hot_x, int hot_y)
+{
+  if (wm == NULL || rgba == NULL || width <= 0 || height <= 0 || hot_x < 0 ||
+      hot_y < 0 || hot_x >= width || hot_y >= height)
+  {
+    LOG_ERROR("Couldn't create cursor. Invalid parameters.");
+    return -1;
+  }
+
+#ifdef GLPS_USE_X11
+  return glps_x11_cursor_create_image(wm, rgba, width, height, hot_x, hot_y);
+#else
+  LOG_WARNING("Image cursors are not supported on this platform.");
+  return -1;
+#endif
+}
+
+void glps_wm_cursor_set_image(glps_WindowManager *wm, size_t cursor_id)
+{
+  if (wm == NULL)
+  {
+    LOG_ERROR("Couldn't set cursor. Window manager is NULL.");
+    return;
+  }
+
+#ifdef GLPS_USE_X11
+  glps_x11_cursor_set_image(wm, cursor_id);
+#else
+  LOG_WARNING("Image cursors are not supported on this platform.");
+#endif
+}
@@ -2,7 +2,15 @@
 
 #include "glps_x11.h"
 #include "glps_egl_context.h"
+#include "glps_event_loop.h"
+#include "glps_frame_scheduler.h"
+#include "glps_frame_stats.h"
+#include "glps_gpu_timer.h"
+#include "glps_input_state.h"
+#include "glps_stats.h"
+#include "glps_trace.h"
 #include <X11/Xatom.h>
+#include <poll.h>
 #include "utils/logger/pico_logger.h"
 
 #define MAX_EVENTS_PER_FRAME 10
@@ -16,6 +24,48 @@
 #define XC_top_side 138
 #define XC_xterm 152
 #define XC_X_cursor 0
+/* Atoms the backend uses, interned together at startup. */
+static const struct
+{
+    const char *name;
+    size_t offset;
+} __x11_atoms[] = {
+    {"WM_DELETE_WINDOW", offsetof(glps_X11Context, wm_delete_window)},
+    {"_NET_WM_STATE", offsetof(glps_X11Context, net_wm_state)},
+    {"_NET_WM_STATE_HIDDEN", offsetof(glps_X11Context, net_wm_state_hidden)},
+    {"_NET_WM_SYNC_REQUEST", offsetof(glps_X11Context, net_wm_sync_request)},
+    {"_NET_WM_SYNC_REQUEST_COUNTER", offsetof(glps_X11Context, net_wm_sync_request_counter)},
+    {"_MOTIF_WM_HINTS", offsetof(glps_X11Context, motif_wm_hints)},
+    {"_NET_WM_WINDOW_TYPE", offsetof(glps_X11Context, net_wm_window_type)},
+    {"_NET_WM_WINDOW_TYPE_NORMAL", offsetof(glps_X11Context, net_wm_window_type_normal)},
+    {"_NET_WM_WINDOW_TYPE_DOCK", offsetof(glps_X11Context, net_wm_window_type_dock)},
+};
+
+#define GLPS_X11_ATOM_COUNT (sizeof(__x11_atoms) / sizeof(__x11_atoms[0]))
+
+// XInternAtoms pipelines every InternAtom request and waits for the replies
+// once, instead of paying a round trip per atom.
+static void __intern_atoms(glps_X11Context *ctx)
+{
+    char *names[GLPS_X11_ATOM_COUNT];
+    Atom atoms[GLPS_X11_ATOM_COUNT];
+
+    for (size_t i = 0; i < GLPS_X11_ATOM_COUNT; ++i)
+    {
+        names[i] = (char *)__x11_atoms[i].name;
+    }
+
+    if (!XInternAtoms(ctx->display, names, GLPS_X11_ATOM_COUNT, False, atoms))
+    {
+        LOG_WARNING("Some X11 atoms could not be interned.");
+    }
+
+    for (size_t i = 0; i < GLPS_X11_ATOM_COUNT; ++i)
+    {
+        *(Atom *)((char *)ctx + __x11_atoms[i].offset) = atoms[i];
+    }
+}
+
 static ssize_t __get_window_id_by_xid(glps_WindowManager *wm, Window xid)
 {
     if (wm == NULL || wm->windows == NULL)
@@ -34,14 +84,190 @@ static ssize_t __get_window_id_by_xid(glps_WindowManager *wm, Window xid)
     return -1;
 }
 
+/* Whether every window has been destroyed. Slots of destroyed windows stay
+ * empty so the ids of the others don't change. */
+static bool __all_windows_closed(glps_WindowManager *wm)
+{
+    for (size_t i = 0; i < wm->window_count; ++i)
+    {
+        if (wm->windows[i] != NULL)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void __set_hidden(glps_WindowManager *wm, size_t window_id,
+                         unsigned int reason, bool hidden)
+{
+    glps_X11Window *window = wm->windows[window_id];
+    bool was_visible = window->hidden_reasons == 0;
+
+    if (hidden)
+        window->hidden_reasons |= reason;
+    else
+        window->hidden_reasons &= ~reason;
+
+    bool visible = window->hidden_reasons == 0;
+    if (visible != was_visible && wm->callbacks.window_visibility_callback)
+    {
+        wm->callbacks.window_visibility_callback(
+            window_id, visible, wm->callbacks.window_visibility_data);
+    }
+}
+
+static bool __has_hidden_state(glps_WindowManager *wm, Window xid)
+{
+    Atom type;
+    int format;
+    unsigned long count, bytes_after;
+    Atom *states = NULL;
+    bool hidden = false;
+
+    if (XGetWindowProperty(wm->x11_ctx->display, xid, wm->x11_ctx->net_wm_state,
+                           0, 64, False, XA_ATOM, &type, &format, &count,
+                           &bytes_after, (unsigned char **)&states) != Success)
+    {
+        return false;
+    }
+
+    for (unsigned long i = 0; states != NULL && i < count; ++i)
+    {
+        if (states[i] == wm->x11_ctx->net_wm_state_hidden)
+        {
+            hidden = true;
+            break;
+        }
+    }
+
+    if (states != NULL)
+        XFree(states);
+    return hidden;
+}
+
+/* Trace span name of an input event's dispatch, NULL for other events. */
+static const char *__input_span_name(int type)
+{
+    switch (type)
+    {
+    case MotionNotify:
+        return "motion_input";
+    case ButtonPress:
+    case ButtonRelease:
+        return "button_input";
+    case KeyPress:
+    case KeyRelease:
+        return "key_input";
+    case EnterNotify:
+    case LeaveNotify:
+        return "crossing_input";
+    case FocusIn:
+    case FocusOut:
+        return "focus_input";
+    default:
+        return NULL;
+    }
+}
+
+/* Whether an event should redraw windows rendered on demand. */
+static bool __is_redraw_event(int type)
+{
+    switch (type)
+    {
+    case MotionNotify:
+    case ButtonPress:
+    case ButtonRelease:
+    case KeyPress:
+    case KeyRelease:
+    case ConfigureNotify:
+    case Expose:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Whether any window has a frame to draw before the next event. */
+static bool __needs_frame(glps_WindowManager *wm)
+{
+    if (__all_windows_closed(wm))
+        return true;
+
+    for (size_t i = 0; i < wm->window_count; ++i)
+    {
+        glps_X11Window *window = wm->windows[i];
+        if (window == NULL || window->hidden_reasons != 0)
+            continue;
+        if (window->render_mode == GLPS_RENDER_CONTINUOUS || window->redraw_requested)
+            return true;
+    }
+
+    return false;
+}
+
+/* Frames run from the scheduler once the events of this dispatch are in. */
+static void __dispatch_frame(glps_WindowManager *wm, size_t window_id)
+{
+    glps_frame_scheduler_ready(wm, window_id);
+}
+
+void glps_x11_window_run_frame(glps_WindowManager *wm, size_t window_id)
+{
+    glps_X11Window *window = wm->windows[window_id];
+
+    // Nothing of a hidden window reaches the screen.
+    if (window->hidden_reasons != 0)
+    {
+        return;
+    }
+
+    window->redraw_requested = false;
+
+    uint64_t trace_start = GLPS_TRACE_BEGIN();
+    glps_frame_stats_begin(&window->frame_stats);
+    wm->callbacks.window_frame_update_callback(
+        window_id,
+        wm->callbacks.window_frame_update_data);
+    GLPS_TRACE_END("frame_callback", trace_start);
+
+    // The callback may have destroyed the window.
+    if (window_id < wm->window_count && wm->windows[window_id] == window)
+    {
+        glps_frame_stats_end(&window->frame_stats);
+    }
+}
+
 void __remove_window(glps_WindowManager *wm, Window xid)
 {
+    // Popups and child windows go with their parent.
+    for (size_t i = 0; i < wm->window_count;)
+    {
+        if (wm->windows[i] != NULL && wm->windows[i]->parent == xid)
+        {
+            __remove_window(wm, wm->windows[i]->window);
+            i = 0;
+            continue;
+        }
+        ++i;
+    }
+
     ssize_t window_id = __get_window_id_by_xid(wm, xid);
     if (window_id < 0)
     {
         return;
     }
 
+    if (wm->windows[window_id]->grab && wm->x11_ctx != NULL &&
+        wm->x11_ctx->display != NULL)
+    {
+        XUngrabPointer(wm->x11_ctx->display, CurrentTime);
+        XUngrabKeyboard(wm->x11_ctx->display, CurrentTime);
+    }
+
+    glps_gpu_timer_destroy(&wm->windows[window_id]->gpu_timer);
+
     if (wm->windows[window_id]->egl_surface != EGL_NO_SURFACE && wm->egl_ctx != NULL)
     {
         eglDestroySurface(wm->egl_ctx->dpy, wm->windows[window_id]->egl_surface);
@@ -50,18 +276,225 @@ void __remove_window(glps_WindowManager *wm, Window xid)
 
     if (wm->x11_ctx != NULL && wm->x11_ctx->display != NULL)
     {
+        if (wm->windows[window_id]->sync_counter != None)
+        {
+            XSyncDestroyCounter(wm->x11_ctx->display, wm->windows[window_id]->sync_counter);
+        }
         XDestroyWindow(wm->x11_ctx->display, wm->windows[window_id]->window);
     }
 
     free(wm->windows[window_id]);
     wm->windows[window_id] = NULL;
+}
+
+/* Releases the grab of a popup clicked outside of and asks the application
+ * to close it, as a compositor dismisses xdg_popups. */
+static void __dismiss_popup(glps_WindowManager *wm, size_t window_id)
+{
+    XUngrabPointer(wm->x11_ctx->display, CurrentTime);
+    XUngrabKeyboard(wm->x11_ctx->display, CurrentTime);
+    wm->windows[window_id]->grab = false;
+
+    if (wm->callbacks.window_close_callback)
+    {
+        wm->callbacks.window_close_callback(window_id,
+                                            wm->callbacks.window_close_data);
+    }
+}
+
+static unsigned int __font_cursor_shape(GLPS_CURSOR_TYPE user_cursor)
+{
+    switch (user_cursor)
+    {
+    case GLPS_CURSOR_IBEAM:
+        return XC_xterm;
+    case GLPS_CURSOR_CROSSHAIR:
+        return XC_crosshair;
+    case GLPS_CURSOR_HAND:
+        return XC_hand1;
+    case GLPS_CURSOR_HRESIZE:
+        return XC_right_side;
+    case GLPS_CURSOR_VRESIZE:
+        return XC_top_side;
+    case GLPS_CURSOR_NOT_ALLOWED:
+        return XC_X_cursor;
+    case GLPS_CURSOR_ARROW:
+    default:
+        return XC_arrow;
+    }
+}
 
-    for (size_t i = window_id; i < wm->window_count - 1; i++)
+static void __track_button(glps_InputState *input, unsigned int button,
+                           bool pressed)
+{
+    switch (button)
+    {
+    case Button1:
+        glps_input_state_button(input, GLPS_MOUSE_BUTTON_LEFT, pressed);
+        break;
+    case Button2:
+        glps_input_state_button(input, GLPS_MOUSE_BUTTON_MIDDLE, pressed);
+        break;
+    case Button3:
+        glps_input_state_button(input, GLPS_MOUSE_BUTTON_RIGHT, pressed);
+        break;
+    // Buttons 4 to 7 are scroll steps; 8 and 9 are the side buttons.
+    case 8:
+        glps_input_state_button(input, GLPS_MOUSE_BUTTON_BACK, pressed);
+        break;
+    case 9:
+        glps_input_state_button(input, GLPS_MOUSE_BUTTON_FORWARD, pressed);
+        break;
+    default:
+        break;
+    }
+}
+
+/* X event mask delivering the GLPS event classes in mask. */
+static long __x11_event_mask(unsigned int mask)
+{
+    // Structure, exposure, visibility and property events drive resizes,
+    // redraws and frame skipping, so they are always selected.
+    long x_mask = StructureNotifyMask | ExposureMask | VisibilityChangeMask |
+                  PropertyChangeMask;
+
+    if (mask & GLPS_EVENT_POINTER_MOTION)
+        x_mask |= PointerMotionMask;
+    // The wheel is reported as buttons 4 to 7.
+    if (mask & (GLPS_EVENT_POINTER_BUTTON | GLPS_EVENT_POINTER_SCROLL))
+        x_mask |= ButtonPressMask | ButtonReleaseMask;
+    if (mask & GLPS_EVENT_POINTER_CROSSING)
+        x_mask |= EnterWindowMask | LeaveWindowMask;
+    if (mask & GLPS_EVENT_KEYBOARD)
+        x_mask |= KeyPressMask | KeyReleaseMask;
+    if (mask & GLPS_EVENT_FOCUS)
+        x_mask |= FocusChangeMask;
+
+    return x_mask;
+}
+
+/* Whether a button event belongs to a class the window subscribed to. */
+static bool __wants_button(glps_X11Window *window, unsigned int button)
+{
+    bool is_scroll = button >= 4 && button <= 7;
+    return window->event_mask &
+           (is_scroll ? GLPS_EVENT_POINTER_SCROLL : GLPS_EVENT_POINTER_BUTTON);
+}
+
+/* Defines the selected cursor on a window unless it already shows it. */
+static void __apply_cursor(glps_WindowManager *wm, size_t window_id)
+{
+    glps_X11Window *window = wm->windows[window_id];
+    if (window->defined_cursor == wm->x11_ctx->cursor)
+        return;
+
+    XDefineCursor(wm->x11_ctx->display, window->window, wm->x11_ctx->cursor);
+    window->defined_cursor = wm->x11_ctx->cursor;
+}
+
+static void __select_cursor(glps_WindowManager *wm, Cursor cursor)
+{
+    wm->x11_ctx->cursor = cursor;
+
+    for (size_t i = 0; i < wm->window_count; ++i)
+    {
+        if (wm->windows[i] != NULL)
+        {
+            __apply_cursor(wm, i);
+        }
+    }
+}
+
+#ifdef GLPS_HAVE_XRANDR
+static double __mode_refresh_hz(const XRRModeInfo *mode)
+{
+    double lines = mode->vTotal;
+    if (mode->modeFlags & RR_DoubleScan)
+        lines *= 2;
+    if (mode->modeFlags & RR_Interlace)
+        lines /= 2;
+
+    if (mode->hTotal == 0 || lines == 0)
+        return GLPS_FALLBACK_REFRESH_HZ;
+
+    return (double)mode->dotClock / ((double)mode->hTotal * lines);
+}
+
+/* Reads every active CRTC-driven output. Returns the number found. */
+static size_t __query_xrandr_outputs(glps_WindowManager *wm)
+{
+    Display *display = wm->x11_ctx->display;
+    size_t count = 0;
+
+    XRRScreenResources *res =
+        XRRGetScreenResourcesCurrent(display, DefaultRootWindow(display));
+    if (res == NULL)
+        return 0;
+
+    for (int i = 0; i < res->noutput && count < GLPS_MAX_OUTPUTS; ++i)
+    {
+        XRROutputInfo *info = XRRGetOutputInfo(display, res, res->outputs[i]);
+        if (info == NULL)
+            continue;
+
+        XRRCrtcInfo *crtc = NULL;
+        if (info->connection == RR_Connected && info->crtc != None)
+            crtc = XRRGetCrtcInfo(display, res, info->crtc);
+
+        if (crtc != NULL)
+        {
+            glps_Output *output = &wm->x11_ctx->outputs[count++];
+            *output = (glps_Output){0};
+            output->id = (uint32_t)res->outputs[i];
+            snprintf(output->name, sizeof(output->name), "%s", info->name);
+            output->x = crtc->x;
+            output->y = crtc->y;
+            output->width = output->logical_width = (int)crtc->width;
+            output->height = output->logical_height = (int)crtc->height;
+            output->scale = 1.0;
+            output->refresh_hz = GLPS_FALLBACK_REFRESH_HZ;
+
+            for (int m = 0; m < res->nmode; ++m)
+            {
+                if (res->modes[m].id == crtc->mode)
+                {
+                    output->refresh_hz = __mode_refresh_hz(&res->modes[m]);
+                    break;
+                }
+            }
+            XRRFreeCrtcInfo(crtc);
+        }
+        XRRFreeOutputInfo(info);
+    }
+
+    XRRFreeScreenResources(res);
+    return count;
+}
+#endif
+
+static void __refresh_outputs(glps_WindowManager *wm)
+{
+    Display *display = wm->x11_ctx->display;
+
+#ifdef GLPS_HAVE_XRANDR
+    if (wm->x11_ctx->has_xrandr)
     {
-        wm->windows[i] = wm->windows[i + 1];
+        wm->x11_ctx->output_count = __query_xrandr_outputs(wm);
+        if (wm->x11_ctx->output_count > 0)
+            return;
     }
-    wm->windows[wm->window_count - 1] = NULL;
-    wm->window_count--;
+#endif
+
+    // Without XRandR the whole screen is reported as a single output.
+    int screen = DefaultScreen(display);
+    glps_Output *output = &wm->x11_ctx->outputs[0];
+    *output = (glps_Output){0};
+    output->id = 1;
+    output->width = output->logical_width = DisplayWidth(display, screen);
+    output->height = output->logical_height = DisplayHeight(display, screen);
+    output->scale = 1.0;
+    output->refresh_hz = GLPS_FALLBACK_REFRESH_HZ;
+    wm->x11_ctx->output_count = 1;
 }
 
 void glps_x11_init(glps_WindowManager *wm)
@@ -88,6 +521,8 @@ void glps_x11_init(glps_WindowManager *wm)
     }
    // wm->x11_ctx->cursor = XCreateFontCursor(wm->x11_ctx->display, XC_arrow);
 
+    // Lets glps_x11_set_event_thread() read the connection from another thread.
+    XInitThreads();
     wm->x11_ctx->display = XOpenDisplay(NULL);
     if (!wm->x11_ctx->display)
     {
@@ -107,10 +542,43 @@ void glps_x11_init(glps_WindowManager *wm)
         exit(EXIT_FAILURE);
     }
 
-    wm->x11_ctx->wm_delete_window = XInternAtom(wm->x11_ctx->display, "WM_DELETE_WINDOW", False);
+    __intern_atoms(wm->x11_ctx);
+
+    int sync_event_base, sync_error_base, sync_major, sync_minor;
+    wm->x11_ctx->has_xsync =
+        XSyncQueryExtension(wm->x11_ctx->display, &sync_event_base, &sync_error_base) &&
+        XSyncInitialize(wm->x11_ctx->display, &sync_major, &sync_minor);
+    if (!wm->x11_ctx->has_xsync)
+    {
+        LOG_WARNING("XSync extension unavailable, resizes won't be synchronized.");
+    }
+
+#ifdef GLPS_HAVE_XRANDR
+    int xrandr_error_base, xrandr_major = 0, xrandr_minor = 0;
+    wm->x11_ctx->has_xrandr =
+        XRRQueryExtension(wm->x11_ctx->display, &wm->x11_ctx->xrandr_event_base,
+                          &xrandr_error_base) &&
+        XRRQueryVersion(wm->x11_ctx->display, &xrandr_major, &xrandr_minor) &&
+        (xrandr_major > 1 || (xrandr_major == 1 && xrandr_minor >= 3));
+    if (wm->x11_ctx->has_xrandr)
+    {
+        XRRSelectInput(wm->x11_ctx->display, DefaultRootWindow(wm->x11_ctx->display),
+                       RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask |
+                           RROutputChangeNotifyMask);
+    }
+    else
+    {
+        LOG_WARNING("XRandR 1.3 unavailable, assuming a single %.0f Hz output.",
+                    GLPS_FALLBACK_REFRESH_HZ);
+    }
+#endif
+    __refresh_outputs(wm);
 }
 
-ssize_t glps_x11_window_create(glps_WindowManager *wm, const char *title,
+/* Creates a window of any role. Popups are placed at root coordinates,
+ * child windows relative to their parent. */
+static ssize_t __window_create(glps_WindowManager *wm, GLPS_WINDOW_ROLE role,
+                               Window parent, const char *title, int x, int y,
                                int width, int height)
 {
     if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL)
@@ -119,104 +587,233 @@ ssize_t glps_x11_window_create(glps_WindowManager *wm, const char *title,
         exit(EXIT_FAILURE);
     }
 
-    if (wm->window_count >= MAX_WINDOWS)
+    // Slots left by destroyed windows are filled first.
+    size_t window_id = 0;
+    while (window_id < wm->window_count && wm->windows[window_id] != NULL)
+    {
+        ++window_id;
+    }
+
+    if (window_id >= MAX_WINDOWS)
     {
         LOG_ERROR("Maximum number of windows reached");
         return -1;
     }
 
     int screen = DefaultScreen(wm->x11_ctx->display);
-    wm->windows[wm->window_count] = (glps_X11Window *)calloc(1, sizeof(glps_X11Window));
-    if (wm->windows[wm->window_count] == NULL)
+    wm->windows[window_id] = (glps_X11Window *)calloc(1, sizeof(glps_X11Window));
+    if (wm->windows[window_id] == NULL)
     {
         LOG_ERROR("Failed to allocate window");
         return -1;
     }
-
-    wm->windows[wm->window_count]->window = XCreateSimpleWindow(
+    glps_frame_stats_init(&wm->windows[window_id]->frame_stats);
+    wm->windows[window_id]->render_scale = 1.0;
+    wm->windows[window_id]->event_mask = GLPS_EVENT_ALL;
+    snprintf(wm->windows[window_id]->properties.title,
+             sizeof(wm->windows[window_id]->properties.title), "%s", title);
+    wm->windows[window_id]->properties.width = width;
+    wm->windows[window_id]->properties.height = height;
+    wm->windows[window_id]->x = x;
+    wm->windows[window_id]->y = y;
+    wm->windows[window_id]->resizable = true;
+    wm->windows[window_id]->role = role;
+    wm->windows[window_id]->parent = parent;
+    // Child windows only move with their parent, which ConfigureNotify
+    // doesn't report to them.
+    wm->windows[window_id]->reparented = role == GLPS_WINDOW_SUBSURFACE;
+
+    Window x_parent = role == GLPS_WINDOW_SUBSURFACE
+                          ? parent
+                          : RootWindow(wm->x11_ctx->display, screen);
+    wm->windows[window_id]->window = XCreateSimpleWindow(
         wm->x11_ctx->display,
-        RootWindow(wm->x11_ctx->display, screen),
-        10, 10, width, height, 1,
+        x_parent,
+        x, y, width, height, role == GLPS_WINDOW_TOPLEVEL ? 1 : 0,
         BlackPixel(wm->x11_ctx->display, screen),
         WhitePixel(wm->x11_ctx->display, screen));
 
-    if (wm->windows[wm->window_count]->window == 0)
+    if (wm->windows[window_id]->window == 0)
     {
         LOG_ERROR("Failed to create X11 window");
-        free(wm->windows[wm->window_count]);
-        wm->windows[wm->window_count] = NULL;
+        free(wm->windows[window_id]);
+        wm->windows[window_id] = NULL;
         return -1;
     }
 
-    XSetWindowBackground(wm->x11_ctx->display, wm->windows[wm->window_count]->window, 0xFFFFFF);
+    XSetWindowBackground(wm->x11_ctx->display, wm->windows[window_id]->window, 0xFFFFFF);
     XSetWindowAttributes swa;
+    unsigned long swa_mask = CWBackingStore;
     swa.backing_store = WhenMapped;
-    XChangeWindowAttributes(wm->x11_ctx->display, wm->windows[wm->window_count]->window, CWBackingStore, &swa);
-    XStoreName(wm->x11_ctx->display, wm->windows[wm->window_count]->window, title);
+    if (role == GLPS_WINDOW_POPUP)
+    {
+        // Menus and tooltips bypass the window manager and restore what they
+        // covered without an Expose round trip.
+        swa.override_redirect = True;
+        swa.save_under = True;
+        swa_mask |= CWOverrideRedirect | CWSaveUnder;
+    }
+    XChangeWindowAttributes(wm->x11_ctx->display, wm->windows[window_id]->window, swa_mask, &swa);
+    XStoreName(wm->x11_ctx->display, wm->windows[window_id]->window, title);
 
-    wm->x11_ctx->gc = XCreateGC(wm->x11_ctx->display, wm->windows[wm->window_count]->window, 0, NULL);
+    wm->x11_ctx->gc = XCreateGC(wm->x11_ctx->display, wm->windows[window_id]->window, 0, NULL);
     if (wm->x11_ctx->gc == NULL)
     {
         LOG_ERROR("Failed to create graphics context");
-        XDestroyWindow(wm->x11_ctx->display, wm->windows[wm->window_count]->window);
-        free(wm->windows[wm->window_count]);
-        wm->windows[wm->window_count] = NULL;
+        XDestroyWindow(wm->x11_ctx->display, wm->windows[window_id]->window);
+        free(wm->windows[window_id]);
+        wm->windows[window_id] = NULL;
         return -1;
     }
 
-    XSetWMProtocols(wm->x11_ctx->display, wm->windows[wm->window_count]->window,
-                    &wm->x11_ctx->wm_delete_window, 1);
+    Atom protocols[2] = {wm->x11_ctx->wm_delete_window, None};
+    int protocol_count = 1;
 
-    long event_mask =
-        PointerMotionMask |
-        ButtonPressMask |
-        ButtonReleaseMask |
-        KeyPressMask |
-        KeyReleaseMask |
-        StructureNotifyMask |
-        ExposureMask;
+    if (wm->x11_ctx->has_xsync && role == GLPS_WINDOW_TOPLEVEL)
+    {
+        XSyncValue initial;
+        XSyncIntToValue(&initial, 0);
+        wm->windows[window_id]->sync_counter =
+            XSyncCreateCounter(wm->x11_ctx->display, initial);
+
+        XChangeProperty(wm->x11_ctx->display, wm->windows[window_id]->window,
+                        wm->x11_ctx->net_wm_sync_request_counter, XA_CARDINAL, 32,
+                        PropModeReplace,
+                        (unsigned char *)&wm->windows[window_id]->sync_counter, 1);
+        protocols[protocol_count++] = wm->x11_ctx->net_wm_sync_request;
+    }
+
+    if (role == GLPS_WINDOW_TOPLEVEL)
+    {
+        XSetWMProtocols(wm->x11_ctx->display, wm->windows[window_id]->window,
+                        protocols, protocol_count);
+    }
 
-    int result = XSelectInput(wm->x11_ctx->display, wm->windows[wm->window_count]->window,
-                              event_mask);
+    int result = XSelectInput(wm->x11_ctx->display, wm->windows[window_id]->window,
+                              __x11_event_mask(GLPS_EVENT_ALL));
     if (result == BadWindow)
     {
         LOG_ERROR("Failed to select input events");
-        XDestroyWindow(wm->x11_ctx->display, wm->windows[wm->window_count]->window);
-        free(wm->windows[wm->window_count]);
-        wm->windows[wm->window_count] = NULL;
+        XDestroyWindow(wm->x11_ctx->display, wm->windows[window_id]->window);
+        free(wm->windows[window_id]);
+        wm->windows[window_id] = NULL;
         return -1;
     }
 
+    // Windows without motion events would otherwise never pick up the cursor.
+    __apply_cursor(wm, window_id);
+
     if (wm->egl_ctx != NULL)
     {
-        wm->windows[wm->window_count]->egl_surface =
+        wm->windows[window_id]->egl_surface =
             eglCreateWindowSurface(wm->egl_ctx->dpy, wm->egl_ctx->conf,
-                                   (NativeWindowType)wm->windows[wm->window_count]->window, NULL);
-        if (wm->windows[wm->window_count]->egl_surface == EGL_NO_SURFACE)
+                                   (NativeWindowType)wm->windows[window_id]->window, NULL);
+        if (wm->windows[window_id]->egl_surface == EGL_NO_SURFACE)
         {
             LOG_ERROR("Failed to create EGL surface");
-            XDestroyWindow(wm->x11_ctx->display, wm->windows[wm->window_count]->window);
-            free(wm->windows[wm->window_count]);
-            wm->windows[wm->window_count] = NULL;
+            XDestroyWindow(wm->x11_ctx->display, wm->windows[window_id]->window);
+            free(wm->windows[window_id]);
+            wm->windows[window_id] = NULL;
             return -1;
         }
     }
 
-    if (wm->window_count == 0)
+    if (wm->egl_ctx != NULL && wm->egl_ctx->ctx == EGL_NO_CONTEXT)
     {
         glps_egl_create_ctx(wm);
-        glps_egl_make_ctx_current(wm, 0);
+        glps_egl_make_ctx_current(wm, window_id);
+    }
+
+    XMapWindow(wm->x11_ctx->display, wm->windows[window_id]->window);
+    XFlush(wm->x11_ctx->display);
+
+    if (window_id == wm->window_count)
+    {
+        ++wm->window_count;
     }
+    return window_id;
+}
+
+ssize_t glps_x11_window_create(glps_WindowManager *wm, const char *title,
+                               int width, int height)
+{
+    return __window_create(wm, GLPS_WINDOW_TOPLEVEL, None, title, 10, 10,
+                           width, height);
+}
 
-    XMapWindow(wm->x11_ctx->display, wm->windows[wm->window_count]->window);
+ssize_t glps_x11_popup_create(glps_WindowManager *wm, size_t parent_id,
+                              int x, int y, int width, int height, bool grab)
+{
+    glps_X11Window *parent = wm->windows[parent_id];
+    Display *display = wm->x11_ctx->display;
+
+    ssize_t window_id = __window_create(wm, GLPS_WINDOW_POPUP, parent->window,
+                                        parent->properties.title,
+                                        parent->x + x, parent->y + y,
+                                        width, height);
+    if (window_id < 0 || !grab)
+        return window_id;
+
+    // Menus take every click so one outside of them can dismiss them.
+    Window xid = wm->windows[window_id]->window;
+    if (XGrabPointer(display, xid, False,
+                     ButtonPressMask | ButtonReleaseMask | PointerMotionMask,
+                     GrabModeAsync, GrabModeAsync, None, None,
+                     CurrentTime) == GrabSuccess)
+    {
+        XGrabKeyboard(display, xid, True, GrabModeAsync, GrabModeAsync,
+                      CurrentTime);
+        wm->windows[window_id]->grab = true;
+    }
+    else
+    {
+        LOG_WARNING("Couldn't grab the pointer for popup %zd.", window_id);
+    }
+
+    return window_id;
+}
+
+ssize_t glps_x11_subsurface_create(glps_WindowManager *wm, size_t parent_id,
+                                   int x, int y, int width, int height)
+{
+    glps_X11Window *parent = wm->windows[parent_id];
+
+    ssize_t window_id = __window_create(wm, GLPS_WINDOW_SUBSURFACE,
+                                        parent->window,
+                                        parent->properties.title, x, y,
+                                        width, height);
+    if (window_id >= 0)
+    {
+        wm->windows[window_id]->x = parent->x + x;
+        wm->windows[window_id]->y = parent->y + y;
+    }
+    return window_id;
+}
+
+void glps_x11_subsurface_set_position(glps_WindowManager *wm, size_t window_id,
+                                      int x, int y)
+{
+    glps_X11Window *window = wm->windows[window_id];
+    ssize_t parent_id = __get_window_id_by_xid(wm, window->parent);
+
+    XMoveWindow(wm->x11_ctx->display, window->window, x, y);
+    if (parent_id >= 0)
+    {
+        window->x = wm->windows[parent_id]->x + x;
+        window->y = wm->windows[parent_id]->y + y;
+    }
     XFlush(wm->x11_ctx->display);
+}
 
-    return wm->window_count++;
+void glps_x11_window_destroy(glps_WindowManager *wm, size_t window_id)
+{
+    __remove_window(wm, wm->windows[window_id]->window);
+    XFlush(wm->x11_ctx->display);
 }
 
 void glps_x11_toggle_window_decorations(glps_WindowManager *wm, bool state, size_t window_id)
 {
-    Atom motif_hints = XInternAtom(wm->x11_ctx->display, "_MOTIF_WM_HINTS", False);
+    Atom motif_hints = wm->x11_ctx->motif_wm_hints;
 
     if (motif_hints != None)
     {
@@ -240,8 +837,9 @@ void glps_x11_toggle_window_decorations(glps_WindowManager *wm, bool state, size
                         PropModeReplace, (unsigned char *)&hints, 5);
     }
 
-    Atom net_wm_window_type = XInternAtom(wm->x11_ctx->display, "_NET_WM_WINDOW_TYPE", False);
-    Atom window_type = state ? XInternAtom(wm->x11_ctx->display, "_NET_WM_WINDOW_TYPE_NORMAL", False) : XInternAtom(wm->x11_ctx->display, "_NET_WM_WINDOW_TYPE_DOCK", False);
+    Atom net_wm_window_type = wm->x11_ctx->net_wm_window_type;
+    Atom window_type = state ? wm->x11_ctx->net_wm_window_type_normal
+                             : wm->x11_ctx->net_wm_window_type_dock;
 
     if (net_wm_window_type != None && window_type != None)
     {
@@ -250,7 +848,195 @@ void glps_x11_toggle_window_decorations(glps_WindowManager *wm, bool state, size
     }
 
     XFlush(wm->x11_ctx->display);
-    XSync(wm->x11_ctx->display, False);
+}
+
+/* Moves events Xlib has read, or can read without blocking, into the ring.
+ * Stops early when the ring is full; the UI thread wakes us once it has
+ * drained it. */
+static size_t __reader_fill(glps_X11Context *ctx)
+{
+    glps_X11EventRing *ring = &ctx->events;
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t pushed = 0;
+
+    XLockDisplay(ctx->display);
+    int queued = XEventsQueued(ctx->display, QueuedAfterReading);
+    while (queued-- > 0 &&
+           head - atomic_load_explicit(&ring->tail, memory_order_acquire) <
+               GLPS_X11_EVENT_RING_CAPACITY)
+    {
+        XNextEvent(ctx->display, &ring->events[head % GLPS_X11_EVENT_RING_CAPACITY]);
+        atomic_store_explicit(&ring->head, ++head, memory_order_release);
+        ++pushed;
+    }
+    XUnlockDisplay(ctx->display);
+
+    return pushed;
+}
+
+static void *__reader_main(void *arg)
+{
+    glps_WindowManager *wm = arg;
+    glps_X11Context *ctx = wm->x11_ctx;
+    int fd = ConnectionNumber(ctx->display);
+
+    glps_trace_set_thread_name("glps-x11-reader");
+
+    while (!glps_event_reader_should_stop(&ctx->reader))
+    {
+        glps_event_reader_wait(&ctx->reader, fd);
+
+        uint64_t span = GLPS_TRACE_BEGIN();
+        size_t pushed = __reader_fill(ctx);
+        GLPS_TRACE_END("x11_read", span);
+
+        if (pushed > 0)
+            glps_event_loop_wake(&wm->event_loop);
+    }
+
+    return NULL;
+}
+
+bool glps_x11_set_event_thread(glps_WindowManager *wm, bool enabled)
+{
+    glps_X11Context *ctx = wm->x11_ctx;
+
+    if (enabled == ctx->reader.running)
+        return true;
+
+    if (!enabled)
+    {
+        // Events still in the ring are picked up by __next_event().
+        glps_event_reader_stop(&ctx->reader);
+        return true;
+    }
+
+    return glps_event_reader_start(&ctx->reader, __reader_main, wm);
+}
+
+static bool __ring_empty(glps_X11EventRing *ring)
+{
+    return atomic_load_explicit(&ring->tail, memory_order_relaxed) ==
+           atomic_load_explicit(&ring->head, memory_order_acquire);
+}
+
+/* Takes the next event from the reader's ring, or straight from Xlib when no
+ * reader runs. Returns false when there is nothing to handle. */
+static bool __next_event(glps_WindowManager *wm, XEvent *event)
+{
+    glps_X11EventRing *ring = &wm->x11_ctx->events;
+
+    if (!__ring_empty(ring))
+    {
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        *event = ring->events[tail % GLPS_X11_EVENT_RING_CAPACITY];
+        atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+        return true;
+    }
+
+    if (wm->x11_ctx->reader.running || XPending(wm->x11_ctx->display) == 0)
+        return false;
+
+    XNextEvent(wm->x11_ctx->display, event);
+    return true;
+}
+
+/* Queue scan of glps_x11_latch_input(). Every event other than motion is a
+ * barrier; only motion behind the last one is merged. */
+typedef struct
+{
+    Window window;
+    size_t barriers; /* Barriers passed in the current scan. */
+    size_t limit;    /* Barriers in the queue when the latch started. */
+} glps_X11MotionScan;
+
+static Bool __count_barriers(Display *display, XEvent *event, XPointer arg)
+{
+    (void)display;
+    glps_X11MotionScan *scan = (glps_X11MotionScan *)arg;
+    if (event->type != MotionNotify)
+        ++scan->barriers;
+    return False;
+}
+
+static Bool __match_tail_motion(Display *display, XEvent *event, XPointer arg)
+{
+    (void)display;
+    glps_X11MotionScan *scan = (glps_X11MotionScan *)arg;
+    if (event->type != MotionNotify)
+    {
+        ++scan->barriers;
+        return False;
+    }
+    return scan->barriers == scan->limit && event->xmotion.window == scan->window;
+}
+
+void glps_x11_latch_input(glps_WindowManager *wm, size_t window_id)
+{
+    glps_X11Window *window = wm->windows[window_id];
+    XEvent event;
+    bool moved = false;
+    uint64_t merged = 0;
+    int x = 0, y = 0;
+
+    if (wm->x11_ctx->reader.running)
+    {
+        // Only peek: the ring is handled in order later, and taking the newest
+        // motion out of it would let older positions win.
+        glps_X11EventRing *ring = &wm->x11_ctx->events;
+        size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        for (size_t i = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+             i != head; ++i)
+        {
+            XEvent *pending = &ring->events[i % GLPS_X11_EVENT_RING_CAPACITY];
+            if (pending->type != MotionNotify)
+            {
+                moved = false;
+            }
+            else if (pending->xmotion.window == window->window)
+            {
+                x = pending->xmotion.x;
+                y = pending->xmotion.y;
+                moved = true;
+            }
+        }
+
+        if (moved)
+            glps_input_state_motion(&window->input, x, y);
+        return;
+    }
+
+    // Drain the window's motion behind the last other event, queued or still
+    // on the connection, into one move. Earlier motion stays in order with
+    // the presses between it.
+    glps_X11MotionScan scan = {.window = window->window};
+    XCheckIfEvent(wm->x11_ctx->display, &event, __count_barriers, (XPointer)&scan);
+    scan.limit = scan.barriers;
+
+    for (;;)
+    {
+        scan.barriers = 0;
+        if (!XCheckIfEvent(wm->x11_ctx->display, &event, __match_tail_motion,
+                           (XPointer)&scan))
+            break;
+
+        merged += moved;
+        x = event.xmotion.x;
+        y = event.xmotion.y;
+        moved = true;
+    }
+
+    if (!moved)
+        return;
+
+    glps_stats_add(GLPS_STAT_COALESCED_EVENTS, merged);
+
+    glps_input_state_motion(&window->input, x, y);
+    if (wm->callbacks.mouse_move_callback)
+    {
+        wm->callbacks.mouse_move_callback(window_id, x, y,
+                                          wm->callbacks.mouse_move_data);
+    }
 }
 
 bool glps_x11_should_close(glps_WindowManager *wm)
@@ -264,10 +1050,39 @@ bool glps_x11_should_close(glps_WindowManager *wm)
     Display *display = wm->x11_ctx->display;
     XEvent event;
 
+    // Sleep until the server has something for us or a task is posted when
+    // there is nothing to draw, or until the caller's deadline.
+    if (!__needs_frame(wm) || wm->wait_timeout_ms >= 0)
+    {
+        XFlush(display);
+        if (wm->x11_ctx->reader.running)
+        {
+            // The reader owns the connection; it wakes us when it has events.
+            if (__ring_empty(&wm->x11_ctx->events))
+                glps_event_loop_poll(&wm->event_loop, -1, wm->wait_timeout_ms);
+        }
+        else if (XPending(display) == 0)
+        {
+            glps_event_loop_poll(&wm->event_loop, ConnectionNumber(display),
+                                 wm->wait_timeout_ms);
+        }
+    }
+
     int events_processed = 0;
-    while (XPending(display) > 0 && events_processed++ < MAX_EVENTS_PER_FRAME)
+    while (events_processed++ < MAX_EVENTS_PER_FRAME && __next_event(wm, &event))
     {
-        XNextEvent(display, &event);
+
+#ifdef GLPS_HAVE_XRANDR
+        // Output changes are reported on the root window.
+        if (wm->x11_ctx->has_xrandr &&
+            (event.type == wm->x11_ctx->xrandr_event_base + RRScreenChangeNotify ||
+             event.type == wm->x11_ctx->xrandr_event_base + RRNotify))
+        {
+            XRRUpdateConfiguration(&event);
+            __refresh_outputs(wm);
+            continue;
+        }
+#endif
 
         ssize_t window_id = __get_window_id_by_xid(wm, event.xany.window);
         if (window_id < 0)
@@ -276,9 +1091,28 @@ bool glps_x11_should_close(glps_WindowManager *wm)
             continue;
         }
 
+        if (__is_redraw_event(event.type))
+        {
+            wm->windows[window_id]->redraw_requested = true;
+        }
+
+        // Input spans run from taking the event to its callbacks returning.
+        const char *input_span = __input_span_name(event.type);
+        uint64_t input_start = input_span != NULL ? GLPS_TRACE_BEGIN() : 0;
+
         switch (event.type)
         {
         case ClientMessage:
+            if (wm->x11_ctx->has_xsync &&
+                (Atom)event.xclient.data.l[0] == wm->x11_ctx->net_wm_sync_request)
+            {
+                // The 64-bit value arrives split into low and high words.
+                XSyncIntsToValue(&wm->windows[window_id]->sync_value,
+                                 (unsigned int)event.xclient.data.l[2],
+                                 (int)event.xclient.data.l[3]);
+                wm->windows[window_id]->sync_state = GLPS_X11_SYNC_REQUESTED;
+                break;
+            }
             if ((Atom)event.xclient.data.l[0] == wm->x11_ctx->wm_delete_window)
             {
                 LOG_INFO("Window close request for window %zd", window_id);
@@ -289,7 +1123,7 @@ bool glps_x11_should_close(glps_WindowManager *wm)
                         wm->callbacks.window_close_data);
                 }
                 __remove_window(wm, event.xclient.window);
-                return (wm->window_count == 0);
+                return __all_windows_closed(wm);
             }
             break;
 
@@ -302,20 +1136,68 @@ bool glps_x11_should_close(glps_WindowManager *wm)
                     wm->callbacks.window_close_data);
             }
             __remove_window(wm, event.xdestroywindow.window);
-            return (wm->window_count == 0);
+            return __all_windows_closed(wm);
+
+        case MapNotify:
+            __set_hidden(wm, (size_t)window_id, GLPS_HIDDEN_UNMAPPED, false);
+            break;
+
+        case UnmapNotify:
+            __set_hidden(wm, (size_t)window_id, GLPS_HIDDEN_UNMAPPED, true);
+            break;
+
+        case VisibilityNotify:
+            __set_hidden(wm, (size_t)window_id, GLPS_HIDDEN_OBSCURED,
+                         event.xvisibility.state == VisibilityFullyObscured);
+            break;
+
+        case PropertyNotify:
+            if (event.xproperty.atom == wm->x11_ctx->net_wm_state)
+            {
+                __set_hidden(wm, (size_t)window_id, GLPS_HIDDEN_MINIMIZED,
+                             __has_hidden_state(wm, event.xproperty.window));
+            }
+            break;
+
+        case ReparentNotify:
+            wm->windows[window_id]->reparented =
+                event.xreparent.parent != DefaultRootWindow(display);
+            if (!wm->windows[window_id]->reparented)
+            {
+                wm->windows[window_id]->x = event.xreparent.x;
+                wm->windows[window_id]->y = event.xreparent.y;
+            }
+            break;
 
         case ConfigureNotify:
+            wm->windows[window_id]->properties.width = event.xconfigure.width;
+            wm->windows[window_id]->properties.height = event.xconfigure.height;
+            // Inside a frame, only the window manager's synthetic notifications
+            // carry root coordinates.
+            if (event.xconfigure.send_event || !wm->windows[window_id]->reparented)
+            {
+                wm->windows[window_id]->x = event.xconfigure.x;
+                wm->windows[window_id]->y = event.xconfigure.y;
+            }
+            if (wm->windows[window_id]->sync_state == GLPS_X11_SYNC_REQUESTED)
+            {
+                wm->windows[window_id]->sync_state = GLPS_X11_SYNC_CONFIGURED;
+            }
             if (wm->callbacks.window_resize_callback)
             {
+                uint64_t trace_start = GLPS_TRACE_BEGIN();
                 wm->callbacks.window_resize_callback(
                     (size_t)window_id,
                     event.xconfigure.width,
                     event.xconfigure.height,
                     wm->callbacks.window_resize_data);
+                GLPS_TRACE_END("resize_callback", trace_start);
             }
             break;
 
         case MotionNotify:
+            glps_input_state_motion(&wm->windows[window_id]->input,
+                                    event.xmotion.x, event.xmotion.y);
             if (wm->callbacks.mouse_move_callback)
             {
                 wm->callbacks.mouse_move_callback(
@@ -324,14 +1206,40 @@ bool glps_x11_should_close(glps_WindowManager *wm)
                     event.xmotion.y,
                     wm->callbacks.mouse_move_data);
             }
-           XDefineCursor(wm->x11_ctx->display, wm->windows[window_id]->window, wm->x11_ctx->cursor);
-                break;
+            // Windows created after the last cursor change pick it up here.
+            __apply_cursor(wm, (size_t)window_id);
+            break;
+
+        case EnterNotify:
+        case LeaveNotify:
+            wm->windows[window_id]->input.pointer_inside = event.type == EnterNotify;
+            glps_input_state_motion(&wm->windows[window_id]->input,
+                                    event.xcrossing.x, event.xcrossing.y);
+            break;
+
+        case FocusIn:
+        case FocusOut:
+            glps_input_state_focus(&wm->windows[window_id]->input,
+                                   event.type == FocusIn);
             break;
 
         case ButtonPress:
+            if (wm->windows[window_id]->grab &&
+                (event.xbutton.x < 0 || event.xbutton.y < 0 ||
+                 event.xbutton.x >= wm->windows[window_id]->properties.width ||
+                 event.xbutton.y >= wm->windows[window_id]->properties.height))
+            {
+                __dismiss_popup(wm, (size_t)window_id);
+                break;
+            }
+            if (!__wants_button(wm->windows[window_id], event.xbutton.button))
+                break;
+            __track_button(&wm->windows[window_id]->input, event.xbutton.button, true);
             switch (event.xbutton.button)
             {
             case 4:
+                glps_input_state_scroll(&wm->windows[window_id]->input,
+                                        GLPS_SCROLL_V_AXIS, 1.0);
                 if (wm->callbacks.mouse_scroll_callback)
                 {
                     wm->callbacks.mouse_scroll_callback((size_t)window_id, GLPS_SCROLL_V_AXIS,
@@ -340,6 +1248,8 @@ bool glps_x11_should_close(glps_WindowManager *wm)
                 }
                 break;
             case 5:
+                glps_input_state_scroll(&wm->windows[window_id]->input,
+                                        GLPS_SCROLL_V_AXIS, -1.0);
                 if (wm->callbacks.mouse_scroll_callback)
                 {
                     wm->callbacks.mouse_scroll_callback((size_t)window_id, GLPS_SCROLL_V_AXIS,
@@ -348,6 +1258,8 @@ bool glps_x11_should_close(glps_WindowManager *wm)
                 }
                 break;
             case 6:
+                glps_input_state_scroll(&wm->windows[window_id]->input,
+                                        GLPS_SCROLL_H_AXIS, -1.0);
                 if (wm->callbacks.mouse_scroll_callback)
                 {
                     wm->callbacks.mouse_scroll_callback((size_t)window_id, GLPS_SCROLL_H_AXIS,
@@ -356,6 +1268,8 @@ bool glps_x11_should_close(glps_WindowManager *wm)
                 }
                 break;
             case 7:
+                glps_input_state_scroll(&wm->windows[window_id]->input,
+                                        GLPS_SCROLL_H_AXIS, 1.0);
                 if (wm->callbacks.mouse_scroll_callback)
                 {
                     wm->callbacks.mouse_scroll_callback((size_t)window_id, GLPS_SCROLL_H_AXIS,
@@ -376,6 +1290,9 @@ bool glps_x11_should_close(glps_WindowManager *wm)
             break;
 
         case ButtonRelease:
+            if (!__wants_button(wm->windows[window_id], event.xbutton.button))
+                break;
+            __track_button(&wm->windows[window_id]->input, event.xbutton.button, false);
             switch (event.xbutton.button)
             {
             case 4:
@@ -396,17 +1313,19 @@ bool glps_x11_should_close(glps_WindowManager *wm)
             break;
 
         case KeyPress:
+        {
+            char buf[32];
+            KeySym keysym;
+            XLookupString(&event.xkey, buf, sizeof(buf), &keysym, NULL);
+            KeyCode keycode = XKeysymToKeycode(wm->x11_ctx->display, keysym);
+            if (keycode == 0)
+            {
+                LOG_ERROR("Keycode not found for keysym %lu", keysym);
+                break;
+            }
+            glps_input_state_key(&wm->windows[window_id]->input, keycode, true);
             if (wm->callbacks.keyboard_callback)
             {
-                char buf[32];
-                KeySym keysym;
-                XLookupString(&event.xkey, buf, sizeof(buf), &keysym, NULL);
-                KeyCode keycode = XKeysymToKeycode(wm->x11_ctx->display, keysym);
-                if (keycode == 0)
-                {
-                    LOG_ERROR("Keycode not found for keysym %lu", keysym);
-                    break;
-                }
                 wm->callbacks.keyboard_callback(
                     (size_t)window_id,
                     true,
@@ -415,21 +1334,24 @@ bool glps_x11_should_close(glps_WindowManager *wm)
                     wm->callbacks.keyboard_data);
             }
             break;
+        }
 
         case KeyRelease:
-            if (wm->callbacks.keyboard_callback)
-            {
-                char buf[32];
-                KeySym keysym;
+        {
+            char buf[32];
+            KeySym keysym;
 
-                XLookupString(&event.xkey, buf, sizeof(buf), &keysym, NULL);
-                KeyCode keycode = XKeysymToKeycode(wm->x11_ctx->display, keysym);
-                if (keycode == 0)
-                {
-                    LOG_ERROR("Keycode not found for keysym %lu", keysym);
-                    break;
-                }
+            XLookupString(&event.xkey, buf, sizeof(buf), &keysym, NULL);
+            KeyCode keycode = XKeysymToKeycode(wm->x11_ctx->display, keysym);
+            if (keycode == 0)
+            {
+                LOG_ERROR("Keycode not found for keysym %lu", keysym);
+                break;
+            }
 
+            glps_input_state_key(&wm->windows[window_id]->input, keycode, false);
+            if (wm->callbacks.keyboard_callback)
+            {
                 LOG_INFO("%lu", keycode);
                 wm->callbacks.keyboard_callback(
                     (size_t)window_id,
@@ -439,13 +1361,12 @@ bool glps_x11_should_close(glps_WindowManager *wm)
                     wm->callbacks.keyboard_data);
             }
             break;
+        }
 
         case Expose:
             if (wm->callbacks.window_frame_update_callback)
             {
-                wm->callbacks.window_frame_update_callback(
-                    (size_t)window_id,
-                    wm->callbacks.window_frame_update_data);
+                __dispatch_frame(wm, (size_t)window_id);
             }
             break;
 
@@ -454,9 +1375,94 @@ bool glps_x11_should_close(glps_WindowManager *wm)
         default:
             break;
         }
+
+        GLPS_TRACE_END(input_span, input_start);
+    }
+
+    // Replies read on this thread may have queued events behind the
+    // reader's back, and a full ring leaves them in Xlib's queue.
+    if (wm->x11_ctx->reader.running && XEventsQueued(display, QueuedAlready) > 0)
+    {
+        glps_event_reader_wake(&wm->x11_ctx->reader);
+    }
+
+    return __all_windows_closed(wm);
+}
+
+void glps_x11_window_swapped(glps_WindowManager *wm, size_t window_id)
+{
+    glps_X11Window *window = wm->windows[window_id];
+    if (window->sync_state != GLPS_X11_SYNC_CONFIGURED)
+    {
+        return;
+    }
+
+    // The frame at the configured size is out; let the window manager go on.
+    XSyncSetCounter(wm->x11_ctx->display, window->sync_counter, window->sync_value);
+    XFlush(wm->x11_ctx->display);
+    window->sync_state = GLPS_X11_SYNC_IDLE;
+}
+
+void glps_x11_window_set_event_mask(glps_WindowManager *wm, size_t window_id,
+                                   unsigned int mask)
+{
+    wm->windows[window_id]->event_mask = mask;
+    XSelectInput(wm->x11_ctx->display, wm->windows[window_id]->window,
+                 __x11_event_mask(mask));
+}
+
+size_t glps_x11_get_outputs(glps_WindowManager *wm, glps_Output *outputs,
+                            size_t max_outputs)
+{
+    size_t count = wm->x11_ctx->output_count;
+
+    if (outputs != NULL)
+    {
+        size_t copied = count < max_outputs ? count : max_outputs;
+        memcpy(outputs, wm->x11_ctx->outputs, copied * sizeof(glps_Output));
+    }
+
+    return count;
+}
+
+bool glps_x11_window_get_output(glps_WindowManager *wm, size_t window_id,
+                                glps_Output *output)
+{
+    const glps_X11Window *window = wm->windows[window_id];
+    int x = window->x;
+    int y = window->y;
+    int width = window->properties.width;
+    int height = window->properties.height;
+
+    if (wm->x11_ctx->output_count == 0)
+        return false;
+
+    // The window belongs to the output it overlaps most.
+    size_t best = 0;
+    long best_area = -1;
+    for (size_t i = 0; i < wm->x11_ctx->output_count; ++i)
+    {
+        const glps_Output *o = &wm->x11_ctx->outputs[i];
+        int left = x > o->x ? x : o->x;
+        int top = y > o->y ? y : o->y;
+        int right = x + width < o->x + o->logical_width
+                        ? x + width
+                        : o->x + o->logical_width;
+        int bottom = y + height < o->y + o->logical_height
+                         ? y + height
+                         : o->y + o->logical_height;
+        long area = right > left && bottom > top
+                        ? (long)(right - left) * (bottom - top)
+                        : 0;
+        if (area > best_area)
+        {
+            best_area = area;
+            best = i;
+        }
     }
 
-    return (wm->window_count == 0);
+    *output = wm->x11_ctx->outputs[best];
+    return true;
 }
 
 void glps_x11_window_update(glps_WindowManager *wm, size_t window_id)
@@ -473,6 +1479,12 @@ void glps_x11_window_update(glps_WindowManager *wm, size_t window_id)
         return;
     }
 
+    if (wm->windows[window_id]->render_mode == GLPS_RENDER_ON_DEMAND &&
+        !wm->windows[window_id]->redraw_requested)
+    {
+        return;
+    }
+
     static struct timespec last_time;
     struct timespec current_time;
     clock_gettime(CLOCK_MONOTONIC, &current_time);
@@ -492,9 +1504,7 @@ void glps_x11_window_update(glps_WindowManager *wm, size_t window_id)
     }
     last_time = current_time;
 
-    wm->callbacks.window_frame_update_callback(
-        window_id,
-        wm->callbacks.window_frame_update_data);
+    __dispatch_frame(wm, window_id);
 
     XFlush(wm->x11_ctx->display);
 }
@@ -506,12 +1516,18 @@ void glps_x11_destroy(glps_WindowManager *wm)
         return;
     }
 
+    if (wm->x11_ctx != NULL)
+    {
+        glps_event_reader_stop(&wm->x11_ctx->reader);
+    }
+
     if (wm->windows)
     {
         for (size_t i = 0; i < wm->window_count; ++i)
         {
             if (wm->windows[i] != NULL)
             {
+                glps_gpu_timer_destroy(&wm->windows[i]->gpu_timer);
                 if (wm->windows[i]->egl_surface != EGL_NO_SURFACE && wm->egl_ctx != NULL)
                 {
                     eglDestroySurface(wm->egl_ctx->dpy, wm->windows[i]->egl_surface);
@@ -541,6 +1557,15 @@ void glps_x11_destroy(glps_WindowManager *wm)
         }
         if (wm->x11_ctx->display)
         {
+            for (size_t i = 0; i < GLPS_CURSOR_TYPE_COUNT; ++i)
+            {
+                if (wm->x11_ctx->cursor_cache[i] != None)
+                    XFreeCursor(wm->x11_ctx->display, wm->x11_ctx->cursor_cache[i]);
+            }
+            for (size_t i = 0; i < wm->x11_ctx->custom_cursor_count; ++i)
+            {
+                XFreeCursor(wm->x11_ctx->display, wm->x11_ctx->custom_cursors[i]);
+            }
             XCloseDisplay(wm->x11_ctx->display);
         }
         free(wm->x11_ctx);
@@ -564,12 +1589,8 @@ void glps_x11_get_window_dimensions(glps_WindowManager *wm, size_t window_id,
         return;
     }
 
-    Window root;
-    int x, y;
-    unsigned int border_width, depth;
-    XGetGeometry(wm->x11_ctx->display, wm->windows[window_id]->window, &root,
-                 &x, &y, (unsigned int *)width, (unsigned int *)height,
-                 &border_width, &depth);
+    *width = wm->windows[window_id]->properties.width;
+    *height = wm->windows[window_id]->properties.height;
 }
 
 void glps_x11_window_is_resizable(glps_WindowManager *wm, bool state, size_t window_id)
@@ -583,15 +1604,11 @@ void glps_x11_window_is_resizable(glps_WindowManager *wm, bool state, size_t win
 
     Display *display = wm->x11_ctx->display;
     Window win = wm->windows[window_id]->window;
+    int width = wm->windows[window_id]->properties.width;
+    int height = wm->windows[window_id]->properties.height;
 
-    Window root;
-    int x, y;
-    unsigned int width, height, border_width, depth;
-    if (!XGetGeometry(display, win, &root, &x, &y, &width, &height, &border_width, &depth))
-    {
-        LOG_ERROR("Failed to get window geometry");
+    if (state && wm->windows[window_id]->resizable)
         return;
-    }
 
     XSizeHints *size_hints = XAllocSizeHints();
     if (size_hints == NULL)
@@ -600,28 +1617,23 @@ void glps_x11_window_is_resizable(glps_WindowManager *wm, bool state, size_t win
         return;
     }
 
-    long supplied_return;
-    XGetWMNormalHints(display, win, size_hints, &supplied_return);
-
+    // The backend owns the normal hints, so they are rebuilt from the cache
+    // rather than read back from the server.
     if (state)
     {
-        size_hints->flags &= ~(PMinSize | PMaxSize);
-        size_hints->min_width = 1;
-        size_hints->min_height = 1;
-        size_hints->max_width = INT_MAX;
-        size_hints->max_height = INT_MAX;
-        size_hints->flags |= PResizeInc;
+        size_hints->flags = PResizeInc;
         size_hints->width_inc = 1;
         size_hints->height_inc = 1;
     }
     else
     {
-        size_hints->flags |= PMinSize | PMaxSize;
+        size_hints->flags = PMinSize | PMaxSize;
         size_hints->min_width = width;
         size_hints->min_height = height;
         size_hints->max_width = width;
         size_hints->max_height = height;
     }
+    wm->windows[window_id]->resizable = state;
 
     XSetWMNormalHints(display, win, size_hints);
     XFree(size_hints);
@@ -652,45 +1664,78 @@ void glps_x11_cursor_change(glps_WindowManager *wm, GLPS_CURSOR_TYPE user_cursor
         return;
     }
 
+    if ((int)user_cursor < 0 || user_cursor >= GLPS_CURSOR_TYPE_COUNT)
+    {
+        LOG_ERROR("Unknown cursor type.");
+        return;
+    }
+
+    // Font cursors are created on first use and kept until shutdown.
+    Cursor *cached = &wm->x11_ctx->cursor_cache[user_cursor];
+    if (*cached == None)
+    {
+        *cached = XCreateFontCursor(wm->x11_ctx->display,
+                                    __font_cursor_shape(user_cursor));
+    }
 
-    int selected_cursor;
+    __select_cursor(wm, *cached);
+}
 
-    switch (user_cursor)
+ssize_t glps_x11_cursor_create_image(glps_WindowManager *wm,
+                                     const unsigned char *rgba, int width,
+                                     int height, int hot_x, int hot_y)
+{
+#ifdef GLPS_HAVE_XCURSOR
+    if (wm->x11_ctx->custom_cursor_count >= GLPS_MAX_CUSTOM_CURSORS)
     {
-    case GLPS_CURSOR_ARROW:
+        LOG_ERROR("Couldn't create cursor. Too many custom cursors.");
+        return -1;
+    }
+
+    XcursorImage *image = XcursorImageCreate(width, height);
+    if (image == NULL)
     {
-        selected_cursor = XC_arrow;
-        break;
+        LOG_ERROR("Couldn't allocate cursor image.");
+        return -1;
     }
-    case GLPS_CURSOR_IBEAM:
-        selected_cursor = XC_xterm;
-        break;
-    case GLPS_CURSOR_CROSSHAIR:
-        selected_cursor = XC_crosshair;
-        break;
-    case GLPS_CURSOR_HAND:
-        selected_cursor = XC_hand1;
-        break;
-    case GLPS_CURSOR_HRESIZE:
-        selected_cursor = XC_right_side;
-        break;
-    case GLPS_CURSOR_VRESIZE:
-        selected_cursor = XC_top_side;
-        break;
-    case GLPS_CURSOR_NOT_ALLOWED:
-    selected_cursor = XC_X_cursor;
-        break;
-    default:
-        selected_cursor = -1;
+
+    image->xhot = (XcursorDim)hot_x;
+    image->yhot = (XcursorDim)hot_y;
+
+    // Xcursor expects premultiplied ARGB.
+    for (int i = 0; i < width * height; ++i)
+    {
+        unsigned int r = rgba[i * 4 + 0];
+        unsigned int g = rgba[i * 4 + 1];
+        unsigned int b = rgba[i * 4 + 2];
+        unsigned int a = rgba[i * 4 + 3];
+        image->pixels[i] = (a << 24) | ((r * a / 255) << 16) |
+                           ((g * a / 255) << 8) | (b * a / 255);
     }
 
-    if(selected_cursor < 0)
+    Cursor cursor = XcursorImageLoadCursor(wm->x11_ctx->display, image);
+    XcursorImageDestroy(image);
+    if (cursor == None)
     {
-        LOG_ERROR("Unknown cursor type.");
+        LOG_ERROR("Couldn't create cursor from image.");
+        return -1;
+    }
+
+    wm->x11_ctx->custom_cursors[wm->x11_ctx->custom_cursor_count] = cursor;
+    return (ssize_t)wm->x11_ctx->custom_cursor_count++;
+#else
+    LOG_WARNING("GLPS was built without Xcursor, image cursors are unavailable.");
+    return -1;
+#endif
+}
+
+void glps_x11_cursor_set_image(glps_WindowManager *wm, size_t cursor_id)
+{
+    if (cursor_id >= wm->x11_ctx->custom_cursor_count)
+    {
+        LOG_ERROR("Unknown custom cursor %zu.", cursor_id);
         return;
     }
 
-    wm->x11_ctx->cursor = XCreateFontCursor(wm->x11_ctx->display, (unsigned int) selected_cursor);
-    
-    LOG_INFO("Cursor updated.");
+    __select_cursor(wm, wm->x11_ctx->custom_cursors[cursor_id]);
 }
\ No newline at end of file
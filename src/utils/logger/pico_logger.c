@@ -34,8 +34,10 @@ static struct timespec start_time = {0};
 
 #endif
 #include <unistd.h>
+#include <stdatomic.h>
 static bool logging_enabled = true;
 static DebugLevel min_log_level = DEBUG_LEVEL_INFO;
+static atomic_size_t dropped_log_count = 0;
 
 typedef struct LogEntry
 {
@@ -86,6 +88,7 @@ void log_message(DebugLevel level, const char *file, int line, const char *func,
 {
     if (!logging_enabled || level < min_log_level)
     {
+        atomic_fetch_add_explicit(&dropped_log_count, 1, memory_order_relaxed);
         return;
     }
 
@@ -146,6 +149,11 @@ void set_minimum_log_level(DebugLevel level)
     min_log_level = level;
 }
 
+size_t get_dropped_log_count(void)
+{
+    return atomic_load_explicit(&dropped_log_count, memory_order_relaxed);
+}
+
 void save_log_file(const char *path)
 {
     FILE *fp = fopen(path, "w");
@@ -0,0 +1,86 @@
+#include "glps_dynamic_resolution.h"
+
+#include <assert.h>
+
+#define TARGET_NS 16000000ull
+
+static void __add_frame(glps_FrameStatsRing *ring, uint64_t frame_ns)
+{
+  uint64_t head = atomic_load(&ring->head);
+  ring->frame_ns[head % GLPS_FRAME_STATS_CAPACITY] = frame_ns;
+  atomic_store(&ring->head, head + 1);
+}
+
+static void __add_gpu(glps_FrameStatsRing *ring, uint64_t gpu_ns)
+{
+  uint64_t head = atomic_load(&ring->gpu_head);
+  ring->gpu_ns[head % GLPS_FRAME_STATS_CAPACITY] = gpu_ns;
+  atomic_store(&ring->gpu_head, head + 1);
+}
+
+static long __area(int width, int height, double scale)
+{
+  int buffer_width, buffer_height;
+  glps_dynamic_resolution_buffer_size(width, height, scale, &buffer_width,
+                                      &buffer_height);
+  return (long)buffer_width * buffer_height;
+}
+
+/* A window on a 2x output keeps its logical size; every step the controller
+ * takes down from full scale must shrink its buffer. */
+static void test_steps_down_reduce_pixels_on_hidpi(void)
+{
+  static glps_FrameStatsRing ring;
+  glps_DynamicResolution dr;
+  glps_dynamic_resolution_start(&dr, TARGET_NS);
+
+  const int width = 1280, height = 720;
+  double current = 1.0;
+  int steps = 0;
+
+  for (int frame = 0; frame < 1000; ++frame)
+  {
+    double scale;
+    __add_frame(&ring, TARGET_NS * 2);
+    if (!glps_dynamic_resolution_update(&dr, &ring, &scale))
+      continue;
+
+    assert(scale < current);
+    assert(__area(width, height, scale) < __area(width, height, current));
+    current = scale;
+    ++steps;
+  }
+
+  assert(steps > 0);
+  assert(current == glps_dynamic_resolution_scale(&dr));
+}
+
+/* Frame intervals keep driving the controller once GPU samples stop. */
+static void test_falls_back_to_frame_intervals(void)
+{
+  static glps_FrameStatsRing ring;
+  glps_DynamicResolution dr;
+  glps_dynamic_resolution_start(&dr, TARGET_NS);
+
+  double scale;
+  __add_gpu(&ring, TARGET_NS / 2);
+  __add_frame(&ring, TARGET_NS / 2);
+  glps_dynamic_resolution_update(&dr, &ring, &scale);
+
+  bool stepped = false;
+  for (int frame = 0; frame < 100 && !stepped; ++frame)
+  {
+    __add_frame(&ring, TARGET_NS * 4);
+    stepped = glps_dynamic_resolution_update(&dr, &ring, &scale);
+  }
+
+  assert(stepped);
+  assert(scale < 1.0);
+}
+
+int main(void)
+{
+  test_steps_down_reduce_pixels_on_hidpi();
+  test_falls_back_to_frame_intervals();
+  return 0;
+}
@@ -0,0 +1,25 @@
+#include "glps_frame_stats.h"
+
+#include <assert.h>
+
+/* Poll timeouts round up, so short waits never spin. */
+static void test_timeout_rounds_up(void)
+{
+  assert(glps_frame_stats_timeout_ms(0) == 0);
+  assert(glps_frame_stats_timeout_ms(500000) == 1);
+  assert(glps_frame_stats_timeout_ms(1000000) == 1);
+  assert(glps_frame_stats_timeout_ms(1500000) == 2);
+  assert(glps_frame_stats_timeout_ms(16666667) == 17);
+}
+
+static void test_timeout_saturates(void)
+{
+  assert(glps_frame_stats_timeout_ms(UINT64_MAX) == INT_MAX);
+}
+
+int main(void)
+{
+  test_timeout_rounds_up();
+  test_timeout_saturates();
+  return 0;
+}
@@ -0,0 +1,55 @@
+#include "glps_dynamic_resolution.h"
+
+#include <assert.h>
+
+static long __area(int width, int height, double scale)
+{
+  int buffer_width, buffer_height;
+  glps_dynamic_resolution_buffer_size(width, height, scale, &buffer_width,
+                                      &buffer_height);
+  return (long)buffer_width * buffer_height;
+}
+
+/* The buffer area never grows as the render scale goes down. */
+static void test_area_follows_scale(void)
+{
+  static const int sizes[][2] = {{1, 1}, {7, 3}, {640, 480}, {1280, 720},
+                                 {1920, 1080}, {3840, 2160}};
+
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+  {
+    long previous = __area(sizes[i][0], sizes[i][1], 1.0);
+    for (int step = 99; step >= 1; --step)
+    {
+      long area = __area(sizes[i][0], sizes[i][1], step / 100.0);
+      assert(area <= previous);
+      previous = area;
+    }
+  }
+}
+
+static void test_full_scale_is_logical_size(void)
+{
+  int buffer_width, buffer_height;
+  glps_dynamic_resolution_buffer_size(1280, 720, 1.0, &buffer_width,
+                                      &buffer_height);
+  assert(buffer_width == 1280 && buffer_height == 720);
+}
+
+static void test_never_empty(void)
+{
+  int buffer_width, buffer_height;
+  glps_dynamic_resolution_buffer_size(1, 1, 0.1, &buffer_width, &buffer_height);
+  assert(buffer_width == 1 && buffer_height == 1);
+
+  glps_dynamic_resolution_buffer_size(0, 0, 0.5, &buffer_width, &buffer_height);
+  assert(buffer_width == 0 && buffer_height == 0);
+}
+
+int main(void)
+{
+  test_area_follows_scale();
+  test_full_scale_is_logical_size();
+  test_never_empty();
+  return 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * @file glps_top.c
+ * @brief Live view of the stats page of a running GLPS application.
+ *
+ * Usage: glps-top <pid> [interval_ms]
+ *
+ * The application publishes its page after glps_wm_set_stats_page() or with
+ * GLPS_STATS_PAGE set in its environment. The page is mapped read-only and
+ * copied under its sequence lock, so the application never waits on us.
+ */
+
+#include "glps_stats_page.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_INTERVAL_MS 500
+
+/* Finds the page among the descriptors of a process; a memfd shows up as a
+ * link to "/memfd:<name> (deleted)". */
+static int __open_page(pid_t pid)
+{
+  char dir_path[64];
+  snprintf(dir_path, sizeof(dir_path), "/proc/%d/fd", (int)pid);
+
+  DIR *dir = opendir(dir_path);
+  if (dir == NULL)
+  {
+    fprintf(stderr, "glps-top: cannot list %s: %s\n", dir_path,
+            strerror(errno));
+    return -1;
+  }
+
+  const char *prefix = "/memfd:" GLPS_STATS_PAGE_NAME;
+  int fd = -1;
+  struct dirent *entry;
+  while (fd < 0 && (entry = readdir(dir)) != NULL)
+  {
+    char link_path[PATH_MAX];
+    char target[PATH_MAX];
+    snprintf(link_path, sizeof(link_path), "%s/%s", dir_path, entry->d_name);
+
+    ssize_t length = readlink(link_path, target, sizeof(target) - 1);
+    if (length < 0)
+      continue;
+    target[length] = '\0';
+
+    if (strncmp(target, prefix, strlen(prefix)) == 0)
+      fd = open(link_path, O_RDONLY | O_CLOEXEC);
+  }
+  closedir(dir);
+
+  if (fd < 0)
+    fprintf(stderr, "glps-top: process %d publishes no stats page\n",
+            (int)pid);
+  return fd;
+}
+
+static void __print_histogram(const glps_StatsPage *page,
+                              const glps_StatsWindow *window)
+{
+  uint32_t total = 0;
+  for (int i = 0; i < GLPS_STATS_HISTOGRAM_BUCKETS; ++i)
+    total += window->histogram[i];
+  if (total == 0)
+    return;
+
+  for (int i = 0; i < GLPS_STATS_HISTOGRAM_BUCKETS; ++i)
+  {
+    if (i < GLPS_STATS_HISTOGRAM_BUCKETS - 1)
+      printf("    <= %6.1f ms ", page->histogram_edges_us[i] / 1000.0);
+    else
+      printf("     > %6.1f ms ", page->histogram_edges_us[i - 1] / 1000.0);
+
+    int width = (int)(40.0 * window->histogram[i] / total + 0.5);
+    printf("%5u ", window->histogram[i]);
+    for (int j = 0; j < width; ++j)
+      putchar('#');
+    putchar('\n');
+  }
+}
+
+static void __print_page(const glps_StatsPage *page,
+                         const glps_StatsPage *previous, double interval_s)
+{
+  // Rates are taken between two reads, so they need no state in the app.
+  double coalesced_rate =
+      previous ? (page->total_coalesced_events -
+                  previous->total_coalesced_events) / interval_s
+               : 0.0;
+
+  printf("\x1B[H\x1B[2J");
+  printf("glps-top  pid %d  publish #%llu\n\n", page->pid,
+         (unsigned long long)page->publish_count);
+  printf("tasks pending          %u\n", page->tasks_pending);
+  printf("display events pending %u\n", page->display_events_pending);
+  printf("coalesced events       %llu (%.0f/s)\n",
+         (unsigned long long)page->total_coalesced_events, coalesced_rate);
+  printf("audio xruns            %llu\n",
+         (unsigned long long)page->total_audio_xruns);
+  printf("log messages dropped   %llu\n\n",
+         (unsigned long long)page->total_log_dropped);
+
+  for (uint32_t i = 0; i < page->window_count && i < GLPS_STATS_MAX_WINDOWS;
+       ++i)
+  {
+    const glps_StatsWindow *window = &page->windows[i];
+    printf("window %u  %6.1f fps  mean %6.2f  p95 %6.2f  p99 %6.2f  max %6.2f "
+           "ms  over budget %llu/%llu\n",
+           window->window_id, window->fps, window->mean_ms, window->p95_ms,
+           window->p99_ms, window->max_ms,
+           (unsigned long long)window->over_budget_frames,
+           (unsigned long long)window->frame_count);
+    __print_histogram(page, window);
+    putchar('\n');
+  }
+  fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    fprintf(stderr, "usage: %s <pid> [interval_ms]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  pid_t pid = (pid_t)strtol(argv[1], NULL, 10);
+  long interval_ms = argc > 2 ? strtol(argv[2], NULL, 10) : DEFAULT_INTERVAL_MS;
+  if (pid <= 0 || interval_ms <= 0)
+  {
+    fprintf(stderr, "usage: %s <pid> [interval_ms]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int fd = __open_page(pid);
+  if (fd < 0)
+    return EXIT_FAILURE;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(glps_StatsPage))
+  {
+    fprintf(stderr, "glps-top: stats page has an unexpected size\n");
+    close(fd);
+    return EXIT_FAILURE;
+  }
+
+  const glps_StatsPage *page =
+      mmap(NULL, sizeof(glps_StatsPage), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (page == MAP_FAILED)
+  {
+    fprintf(stderr, "glps-top: cannot map stats page: %s\n", strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  if (page->magic != GLPS_STATS_PAGE_MAGIC ||
+      page->version != GLPS_STATS_PAGE_VERSION)
+  {
+    fprintf(stderr, "glps-top: stats page version %u, expected %u\n",
+            page->version, GLPS_STATS_PAGE_VERSION);
+    return EXIT_FAILURE;
+  }
+
+  static glps_StatsPage copies[2];
+  int current = 0;
+  bool have_previous = false;
+  struct timespec delay = {interval_ms / 1000, (interval_ms % 1000) * 1000000};
+
+  // The mapping outlives the process; stop once it is gone.
+  while (kill(pid, 0) == 0 || errno == EPERM)
+  {
+    if (glps_stats_page_read(page, &copies[current]))
+    {
+      __print_page(&copies[current], have_previous ? &copies[!current] : NULL,
+                   interval_ms / 1000.0);
+      have_previous = true;
+      current = !current;
+    }
+    nanosleep(&delay, NULL);
+  }
+
+  printf("\nglps-top: process %d exited\n", (int)pid);
+  munmap((void *)page, sizeof(glps_StatsPage));
+  return EXIT_SUCCESS;
+}